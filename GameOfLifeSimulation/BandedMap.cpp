@@ -0,0 +1,47 @@
+#include "BandedMap.h"
+
+BandedMap::BandedMap(unsigned int w, unsigned int h, unsigned int threads)
+	: CellMap(w, h), pool(threads)
+{
+	// Two bands per thread, each at least two rows, and an even number of them
+	unsigned int bands = pool.ThreadCount() * 2;
+	if (bands > h / 2)
+		bands = h / 2;
+	bands &= ~1u;
+
+	// Too short to split safely
+	if (bands < 2)
+		bands = 1;
+
+	for (unsigned int i = 0; i <= bands; i++)
+		band_start.push_back((unsigned int)((unsigned long long)h * i / bands));
+	band_copied.assign(bands, 0);
+}
+
+void BandedMap::NextGen()
+{
+	unsigned int bands = (unsigned int)band_start.size() - 1;
+	unsigned int i;
+
+	if (bands == 1) {
+		CellMap::NextGen();
+		return;
+	}
+
+	// Bring temp map up to date to keep an unaltered version
+	TaskGroup copy;
+	for (i = 0; i < bands; i++)
+		pool.Submit(copy, [this, i] { band_copied[i] = SyncRows(band_start[i], band_start[i + 1]); });
+	pool.Wait(copy);
+	for (i = 0; i < bands; i++)
+		bytes_copied += band_copied[i];
+
+	// Even bands, then odd bands
+	for (unsigned int parity = 0; parity < 2; parity++) {
+		TaskGroup group;
+		for (i = parity; i < bands; i += 2)
+			pool.Submit(group, [this, i] { NextGenRows(band_start[i], band_start[i + 1]); });
+		pool.Wait(group);
+	}
+	generations++;
+}
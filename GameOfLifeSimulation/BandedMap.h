@@ -0,0 +1,36 @@
+#pragma once
+
+#include "CellMap.h"
+#include "ThreadPool.h"
+
+#include <vector>
+
+// BAND STRUCTURE
+/*
+Cells use the CellMap byte layout, with the rows split into an even
+number of horizontal bands of at least two rows each, two bands per
+thread. Every band reads only its own rows of temp_cells, but
+SetCell/ClearCell also add to the counts of the row above and below it,
+which belong to the neighbouring bands. NextGen therefore runs in three
+phases on the thread pool:
+	1. every band copies its dirty rows to temp_cells
+	2. the even bands are processed
+	3. the odd bands are processed
+Bands of the same parity are at least two rows apart (the band count is
+even, so this holds across the wraparound too) and never write to the
+same byte or mark the same row dirty. Counts are only ever added to, so
+the map after each generation is identical to CellMap's whatever the
+number of threads.
+*/
+
+// BandedMap is a CellMap whose NextGen runs on several threads
+class BandedMap final : public CellMap
+{
+public:
+	BandedMap(unsigned int w, unsigned int h, unsigned int threads);
+	void NextGen();
+private:
+	ThreadPool pool;
+	std::vector<unsigned int> band_start; // First row of each band, plus height at the end
+	std::vector<size_t> band_copied; // Bytes each band copied to temp_cells this generation
+};
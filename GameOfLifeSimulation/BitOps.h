@@ -0,0 +1,34 @@
+// Small bit manipulation helpers shared by the packed engines
+#pragma once
+
+#include <cstdint>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Index of the lowest set bit (word must be non-zero)
+inline unsigned int LowestBit(uint64_t word)
+{
+#if defined(_MSC_VER) && defined(_WIN64)
+	unsigned long index;
+	_BitScanForward64(&index, word);
+	return index;
+#elif defined(_MSC_VER)
+	unsigned long index;
+	if (_BitScanForward(&index, (unsigned long)word))
+		return index;
+	_BitScanForward(&index, (unsigned long)(word >> 32));
+	return index + 32;
+#else
+	return __builtin_ctzll(word);
+#endif
+}
+
+// Adds three words bitwise, giving a sum and carry word
+inline void FullAdd(uint64_t a, uint64_t b, uint64_t c, uint64_t& sum, uint64_t& carry)
+{
+	uint64_t t = a ^ b;
+	sum = t ^ c;
+	carry = (a & b) | (t & c);
+}
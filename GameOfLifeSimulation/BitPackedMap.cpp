@@ -0,0 +1,113 @@
+#include "BitPackedMap.h"
+#include "BitOps.h"
+#include "Common.h"
+
+#include <cstring>
+
+BitPackedMap::BitPackedMap(unsigned int w, unsigned int h) : LifeEngine(w, h)
+{
+	words_per_row = (w + 63) / 64;
+	last_bit = (w - 1) % 64;
+	tail_mask = (last_bit == 63) ? ~0ULL : ((1ULL << (last_bit + 1)) - 1);
+	rows = new uint64_t[words_per_row * h];  // cell storage
+	next_rows = new uint64_t[words_per_row * h]; // next generation storage
+	memset(rows, 0, words_per_row * h * sizeof(uint64_t));  // clear all cells, to start
+}
+
+BitPackedMap::~BitPackedMap()
+{
+	delete[] rows;
+	delete[] next_rows;
+}
+
+void BitPackedMap::SetCell(unsigned int x, unsigned int y)
+{
+	rows[y * words_per_row + x / 64] |= 1ULL << (x % 64);
+}
+
+// The bitmap has the same layout as the map
+void BitPackedMap::LoadStateBitmap(const uint64_t* bitmap, unsigned int words_per_row)
+{
+	memcpy(rows, bitmap, (size_t)words_per_row * height * sizeof(uint64_t));
+}
+
+void BitPackedMap::ClearCell(unsigned int x, unsigned int y)
+{
+	rows[y * words_per_row + x / 64] &= ~(1ULL << (x % 64));
+}
+
+int BitPackedMap::CellState(int x, int y)
+{
+	return (rows[y * words_per_row + x / 64] >> (x % 64)) & 1;
+}
+
+// Word whose bit b holds the state of the cell to the left of cell b,
+// wrapping the first cell of the row around to the last
+inline uint64_t BitPackedMap::West(const uint64_t* row, unsigned int i) const
+{
+	uint64_t carry = (i == 0) ? row[words_per_row - 1] >> last_bit : row[i - 1] >> 63;
+	return (row[i] << 1) | carry;
+}
+
+// Word whose bit b holds the state of the cell to the right of cell b,
+// wrapping the last cell of the row around to the first
+inline uint64_t BitPackedMap::East(const uint64_t* row, unsigned int i) const
+{
+	if (i + 1 < words_per_row)
+		return (row[i] >> 1) | (row[i + 1] << 63);
+	return (row[i] >> 1) | ((row[0] & 1) << last_bit);
+}
+
+void BitPackedMap::NextGen()
+{
+	unsigned int x, y, i;
+	unsigned int h = height, n = words_per_row;
+	const uint64_t *above, *row, *below;
+	uint64_t *next_row, *swap;
+
+	for (y = 0; y < h; y++) {
+
+		row = rows + y * n;
+		above = (y == 0) ? rows + (h - 1) * n : row - n;
+		below = (y == (h - 1)) ? rows : row + n;
+		next_row = next_rows + y * n;
+
+		for (i = 0; i < n; i++) {
+
+			uint64_t s_above, c_above, s_below, c_below, s_mid, c_mid;
+			uint64_t ones, c_ones, twos_part, c_twos, twos, fours;
+
+			// Sum the three cells above, the three below and the two beside
+			FullAdd(West(above, i), above[i], East(above, i), s_above, c_above);
+			FullAdd(West(below, i), below[i], East(below, i), s_below, c_below);
+			s_mid = West(row, i) ^ East(row, i);
+			c_mid = West(row, i) & East(row, i);
+
+			// Combine into a 3-bit count (8 neighbours wraps to 0, which
+			// gives the same result as 8 for Conway's rules)
+			FullAdd(s_above, s_below, s_mid, ones, c_ones);
+			FullAdd(c_above, c_below, c_mid, twos_part, c_twos);
+			twos = twos_part ^ c_ones;
+			fours = c_twos ^ (twos_part & c_ones);
+
+			// Alive next if 3 neighbours, or 2 neighbours and already alive
+			next_row[i] = twos & ~fours & (ones | row[i]);
+		}
+		next_row[n - 1] &= tail_mask;
+
+		// Draw the cells that changed
+		for (i = 0; i < n; i++) {
+			uint64_t changed = next_row[i] ^ row[i];
+			while (changed) {
+				unsigned int bit = LowestBit(changed);
+				x = i * 64 + bit;
+				DrawCell(x, y, ((next_row[i] >> bit) & 1) ? ON_COLOUR : OFF_COLOUR);
+				changed &= changed - 1;
+			}
+		}
+	}
+
+	swap = rows;
+	rows = next_rows;
+	next_rows = swap;
+}
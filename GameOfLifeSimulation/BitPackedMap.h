@@ -0,0 +1,37 @@
+#pragma once
+
+#include "LifeEngine.h"
+
+#include <cstdint>
+
+// BIT-PACKED STRUCTURE
+/*
+Cells are stored one bit per cell in 64-bit words, 64 cells to a
+word, with each row padded up to a whole number of words (padding
+bits are always 0). Cell x of a row lives in bit x % 64 of word x / 64.
+Neighbour counts are not stored; NextGen sums the eight shifted
+neighbour words with bit-parallel full adders so a whole word of
+cells is advanced at once.
+*/
+
+// BitPackedMap stores the cell map as one bit per cell
+class BitPackedMap final : public LifeEngine
+{
+public:
+	BitPackedMap(unsigned int w, unsigned int h);
+	~BitPackedMap();
+	void SetCell(unsigned int x, unsigned int y);
+	void ClearCell(unsigned int x, unsigned int y);
+	int CellState(int x, int y);
+	void LoadStateBitmap(const uint64_t* bitmap, unsigned int words_per_row);
+	void NextGen();
+private:
+	uint64_t West(const uint64_t* row, unsigned int i) const;
+	uint64_t East(const uint64_t* row, unsigned int i) const;
+
+	uint64_t* rows;
+	uint64_t* next_rows;
+	unsigned int words_per_row;
+	unsigned int last_bit; // Bit index of cell (width - 1) in the last word of a row
+	uint64_t tail_mask; // Valid bits of the last word of a row
+};
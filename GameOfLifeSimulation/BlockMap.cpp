@@ -0,0 +1,172 @@
+#include "BlockMap.h"
+#include "BitOps.h"
+#include "Common.h"
+
+#include <cstring>
+
+// Next state of the centre 2x2 of every 4x4 square, in bits 0, 1, 4 and 5
+// so that it can be shifted straight into place in a block
+static unsigned char next_quad[1 << 16];
+static bool next_quad_built = false;
+
+static void BuildNextQuad()
+{
+	for (unsigned int i = 0; i < (1 << 16); i++) {
+		unsigned int next = 0, x, y, dx, dy;
+		for (y = 1; y <= 2; y++) {
+			for (x = 1; x <= 2; x++) {
+				unsigned int alive = (i >> (y * 4 + x)) & 1;
+				unsigned int count = 0;
+				for (dy = y - 1; dy <= y + 1; dy++)
+					for (dx = x - 1; dx <= x + 1; dx++)
+						count += (i >> (dy * 4 + dx)) & 1;
+				count -= alive;
+
+				// On cell stays on with 2 or 3 neighbours, off cell turns on with 3
+				if (count == 3 || (alive && count == 2))
+					next |= 1 << ((y - 1) * 4 + (x - 1));
+			}
+		}
+		next_quad[i] = (unsigned char)next;
+	}
+	next_quad_built = true;
+}
+
+// Mask of the first n columns in every row of a block
+static uint16_t ColumnMask(unsigned int n)
+{
+	uint16_t row = (uint16_t)((1 << n) - 1);
+	return (uint16_t)(row | (row << 4) | (row << 8) | (row << 12));
+}
+
+BlockMap::BlockMap(unsigned int w, unsigned int h) : LifeEngine(w, h)
+{
+	if (!next_quad_built)
+		BuildNextQuad();
+
+	blocks_x = (w + 3) / 4;
+	blocks_y = (h + 3) / 4;
+	last_column_mask = ColumnMask((w - 1) % 4 + 1);
+	last_row_mask = (uint16_t)((1u << (((h - 1) % 4 + 1) * 4)) - 1);
+	blocks = new uint16_t[blocks_x * blocks_y];
+	next_blocks = new uint16_t[blocks_x * blocks_y];
+	memset(blocks, 0, blocks_x * blocks_y * sizeof(uint16_t));
+}
+
+BlockMap::~BlockMap()
+{
+	delete[] blocks;
+	delete[] next_blocks;
+}
+
+void BlockMap::SetCell(unsigned int x, unsigned int y)
+{
+	blocks[(y / 4) * blocks_x + x / 4] |= 1 << ((y % 4) * 4 + x % 4);
+}
+
+void BlockMap::ClearCell(unsigned int x, unsigned int y)
+{
+	blocks[(y / 4) * blocks_x + x / 4] &= ~(1 << ((y % 4) * 4 + x % 4));
+}
+
+int BlockMap::CellState(int x, int y)
+{
+	return (blocks[(y / 4) * blocks_x + x / 4] >> ((y % 4) * 4 + x % 4)) & 1;
+}
+
+// Fills window[i] with the 6 cells of row by * 4 - 1 + i from
+// bx * 4 - 1 to bx * 4 + 4, for a block whose eight neighbours are
+// all full blocks inside the map. Returns false without filling the
+// window if all nine blocks are empty.
+inline bool BlockMap::GatherWindow(unsigned int bx, unsigned int by, unsigned int window[6]) const
+{
+	const uint16_t* above = blocks + (by - 1) * blocks_x + bx;
+	const uint16_t* row = above + blocks_x;
+	const uint16_t* below = row + blocks_x;
+
+	if ((above[-1] | above[0] | above[1] | row[-1] | row[0] | row[1] | below[-1] | below[0] | below[1]) == 0)
+		return false;
+
+	window[0] = ((above[-1] >> 15) & 1) | ((above[0] >> 11) & 0x1E) | ((above[1] >> 7) & 0x20);
+	for (unsigned int r = 0; r < 4; r++) {
+		unsigned int s = r * 4;
+		window[r + 1] = ((row[-1] >> (s + 3)) & 1) | (((row[0] >> s) & 0xF) << 1) | (((row[1] >> s) & 1) << 5);
+	}
+	window[5] = ((below[-1] >> 3) & 1) | ((below[0] & 0xF) << 1) | ((below[1] & 1) << 5);
+	return true;
+}
+
+// As GatherWindow, for blocks on the edges of the map: every cell is
+// looked up separately, wrapping around. Positions past the last row or
+// column wrap to the first, which is what the real cells next to them need.
+bool BlockMap::GatherEdgeWindow(unsigned int bx, unsigned int by, unsigned int window[6]) const
+{
+	unsigned int any = 0;
+
+	for (unsigned int i = 0; i < 6; i++) {
+		unsigned int y = (by * 4 + i + height - 1) % height;
+		window[i] = 0;
+		for (unsigned int j = 0; j < 6; j++) {
+			unsigned int x = (bx * 4 + j + width - 1) % width;
+			window[i] |= ((blocks[(y / 4) * blocks_x + x / 4] >> ((y % 4) * 4 + x % 4)) & 1) << j;
+		}
+		any |= window[i];
+	}
+	return any != 0;
+}
+
+void BlockMap::NextGen()
+{
+	unsigned int bx, by, q;
+	unsigned int window[6];
+	uint16_t *swap;
+
+	for (by = 0; by < blocks_y; by++) {
+		bool edge_row = by == 0 || (by + 1) * 4 >= height;
+
+		for (bx = 0; bx < blocks_x; bx++) {
+
+			bool live;
+			if (edge_row || bx == 0 || (bx + 1) * 4 >= width)
+				live = GatherEdgeWindow(bx, by, window);
+			else
+				live = GatherWindow(bx, by, window);
+
+			// Dead windows stay dead (and the block was already empty)
+			unsigned int b = by * blocks_x + bx;
+			if (!live) {
+				next_blocks[b] = 0;
+				continue;
+			}
+
+			// Look up each 2x2 quadrant from the 4x4 square around it
+			unsigned int next = 0;
+			for (q = 0; q < 4; q++) {
+				unsigned int qx = (q & 1) * 2, qy = (q >> 1) * 2;
+				unsigned int index =
+					((window[qy] >> qx) & 0xF) | (((window[qy + 1] >> qx) & 0xF) << 4) |
+					(((window[qy + 2] >> qx) & 0xF) << 8) | (((window[qy + 3] >> qx) & 0xF) << 12);
+				next |= next_quad[index] << (qy * 4 + qx);
+			}
+
+			// Padding cells past the edge of the map stay dead
+			if (bx == blocks_x - 1)
+				next &= last_column_mask;
+			if (by == blocks_y - 1)
+				next &= last_row_mask;
+			next_blocks[b] = (uint16_t)next;
+
+			// Draw the cells that changed
+			uint64_t changed = next ^ blocks[b];
+			while (changed) {
+				unsigned int bit = LowestBit(changed);
+				DrawCell(bx * 4 + bit % 4, by * 4 + bit / 4, ((next >> bit) & 1) ? ON_COLOUR : OFF_COLOUR);
+				changed &= changed - 1;
+			}
+		}
+	}
+
+	swap = blocks;
+	blocks = next_blocks;
+	next_blocks = swap;
+}
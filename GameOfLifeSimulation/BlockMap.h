@@ -0,0 +1,41 @@
+#pragma once
+
+#include "LifeEngine.h"
+
+#include <cstdint>
+
+// BLOCK STRUCTURE
+/*
+Cells are stored sixteen to a 16-bit word, as 4x4 blocks: cell (x, y)
+of the map lives in bit (y % 4) * 4 + x % 4 of block (x / 4, y / 4).
+Blocks on the right and bottom edges are padded with dead cells when
+the map size is not a multiple of 4.
+
+The next state of a 2x2 square depends only on the 4x4 square around
+it, so a 65536-entry table indexed by those 16 bits gives four new cells
+per lookup. NextGen gathers the 6x6 window made of a block and the ring
+of cells around it, and looks up the four 2x2 quadrants of the block.
+Blocks whose eight neighbours and themselves are all empty are skipped.
+*/
+
+// BlockMap advances the map four cells per table lookup
+class BlockMap final : public LifeEngine
+{
+public:
+	BlockMap(unsigned int w, unsigned int h);
+	~BlockMap();
+	void SetCell(unsigned int x, unsigned int y);
+	void ClearCell(unsigned int x, unsigned int y);
+	int CellState(int x, int y);
+	void NextGen();
+private:
+	bool GatherWindow(unsigned int bx, unsigned int by, unsigned int window[6]) const;
+	bool GatherEdgeWindow(unsigned int bx, unsigned int by, unsigned int window[6]) const;
+
+	uint16_t* blocks;
+	uint16_t* next_blocks;
+	unsigned int blocks_x;
+	unsigned int blocks_y;
+	uint16_t last_column_mask; // Real cells of the blocks in the last block column
+	uint16_t last_row_mask; // Real cells of the blocks in the last block row
+};
@@ -0,0 +1,298 @@
+// BASED ON MICHAEL ABRASH'S GRAPHICS PROGRAMMING BLACK BOOK CHAPTER 17
+#include "CellMap.h"
+#include "Common.h"
+#include "CpuFeatures.h"
+
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+CellMap::CellMap(unsigned int w, unsigned int h) : CellMap(w, h, true)
+{
+}
+
+// Engines that keep their own copy of the previous generation can do
+// without temp_cells, which is then NULL
+CellMap::CellMap(unsigned int w, unsigned int h, bool temp_map) : LifeEngine(w, h)
+{
+	length_in_bytes = w * h;
+	cells = new unsigned char[length_in_bytes];  // cell storage
+	memset(cells, 0, length_in_bytes);  // clear all cells, to start
+	temp_cells = NULL;
+	if (temp_map) {
+		temp_cells = new unsigned char[length_in_bytes]; // temp cell storage
+		memset(temp_cells, 0, length_in_bytes);
+	}
+	dirty_rows = new unsigned char[h]; // rows changed since the last copy
+	memset(dirty_rows, 0, h);
+	bytes_copied = 0;
+	generations = 0;
+	conway = true;
+	decay_start = 0;
+	SetKernel(KERNEL_AVX2); // widest available NextGen kernel
+}
+
+CellMap::~CellMap()
+{
+	delete[] cells;
+	delete[] temp_cells;
+	delete[] dirty_rows;
+}
+
+void CellMap::SetCell(unsigned int x, unsigned int y)
+{
+	cells[y * width + x] &= ~CELL_DECAY_MASK; // No longer dying
+	AddCell(x, y);
+	MarkDirty(y);
+}
+
+void CellMap::ClearCell(unsigned int x, unsigned int y)
+{
+	RemoveCell(x, y);
+	MarkDirty(y);
+}
+
+void CellMap::SetCells(const CellCoord* coords, size_t count)
+{
+	ChangeCells(coords, count, true);
+}
+
+void CellMap::ClearCells(const CellCoord* coords, size_t count)
+{
+	ChangeCells(coords, count, false);
+}
+
+// Sorts the cells by row (a counting sort, linear in the batch) and
+// applies each row's cells together. A row's cells only touch that row
+// and the two beside it, so the counts they change stay in cache
+// instead of the batch hopping about the map per cell
+void CellMap::ChangeCells(const CellCoord* coords, size_t count, bool set)
+{
+	unsigned int h = height, y;
+	size_t i;
+
+	vector<size_t> row_start(h + 1, 0);
+	for (i = 0; i < count; i++)
+		row_start[coords[i].y + 1]++;
+	for (y = 0; y < h; y++)
+		row_start[y + 1] += row_start[y];
+
+	vector<CellCoord> sorted(count);
+	vector<size_t> next(row_start.begin(), row_start.end() - 1);
+	for (i = 0; i < count; i++)
+		sorted[next[coords[i].y]++] = coords[i];
+
+	for (y = 0; y < h; y++) {
+		size_t begin = row_start[y], end = row_start[y + 1];
+		if (begin != end && ChangeRow(y, &sorted[begin], end - begin, set))
+			MarkDirty(y);
+	}
+}
+
+// Sets (or clears) the cells of row y in run, returning true if any
+// changed. Cells already in that state (or repeated) are skipped
+bool CellMap::ChangeRow(unsigned int y, const CellCoord* run, size_t count, bool set)
+{
+	unsigned int w = width, h = height;
+	unsigned char* row = cells + y * w;
+	unsigned char* above = cells + ((y == 0) ? h - 1 : y - 1) * w;
+	unsigned char* below = cells + ((y == h - 1) ? 0 : y + 1) * w;
+	unsigned char delta = set ? 0x02 : (unsigned char)-0x02;
+	bool changed = false;
+
+	for (size_t i = 0; i < count; i++) {
+		unsigned int x = run[i].x;
+		if ((row[x] & 0x01) == (set ? 1 : 0))
+			continue;
+		if (set)
+			row[x] = (row[x] & ~CELL_DECAY_MASK) | 0x01; // No longer dying
+		else
+			row[x] &= ~0x01;
+
+		unsigned int left = (x == 0) ? w - 1 : x - 1;
+		unsigned int right = (x == w - 1) ? 0 : x + 1;
+		above[left] += delta;
+		above[x] += delta;
+		above[right] += delta;
+		row[left] += delta;
+		row[right] += delta;
+		below[left] += delta;
+		below[x] += delta;
+		below[right] += delta;
+		changed = true;
+	}
+	return changed;
+}
+
+void CellMap::AddCell(unsigned int x, unsigned int y)
+{
+	int w = width, h = height;
+	int xoleft, xoright, yoabove, yobelow;
+	unsigned char *cell_ptr = cells + (y * w) + x;
+
+	// Calculate the offsets to the eight neighboring cells,
+	// accounting for wrapping around at the edges of the cell map
+	xoleft = (x == 0) ? w - 1 : -1;
+	xoright = (x == (w - 1)) ? -(w - 1) : 1;
+	yoabove = (y == 0) ? length_in_bytes - w : -w;
+	yobelow = (y == (h - 1)) ? -(length_in_bytes - w) : w;
+
+	*(cell_ptr) |= 0x01; // Set first bit to 1
+
+	// Change successive bits for neighbour counts
+	*(cell_ptr + yoabove + xoleft) += 0x02;
+	*(cell_ptr + yoabove) += 0x02;
+	*(cell_ptr + yoabove + xoright) += 0x02;
+	*(cell_ptr + xoleft) += 0x02;
+	*(cell_ptr + xoright) += 0x02;
+	*(cell_ptr + yobelow + xoleft) += 0x02;
+	*(cell_ptr + yobelow) += 0x02;
+	*(cell_ptr + yobelow + xoright) += 0x02;
+}
+
+void CellMap::RemoveCell(unsigned int x, unsigned int y)
+{
+	int w = width, h = height;
+	int xoleft, xoright, yoabove, yobelow;
+	unsigned char *cell_ptr = cells + (y * w) + x;
+
+	// Calculate the offsets to the eight neighboring cells,
+	// accounting for wrapping around at the edges of the cell map
+	xoleft = (x == 0) ? w - 1 : -1;
+	xoright = (x == (w - 1)) ? -(w - 1) : 1;
+	yoabove = (y == 0) ? length_in_bytes - w : -w;
+	yobelow = (y == (h - 1)) ? -(length_in_bytes - w) : w;
+
+
+	*(cell_ptr) &= ~0x01; // Set first bit to 0
+
+	// Change successive bits for neighbour counts
+	*(cell_ptr + yoabove + xoleft) -= 0x02;
+	*(cell_ptr + yoabove) -= 0x02;
+	*(cell_ptr + yoabove + xoright) -= 0x02;
+	*(cell_ptr + xoleft) -= 0x02;
+	*(cell_ptr + xoright) -= 0x02;
+	*(cell_ptr + yobelow + xoleft) -= 0x02;
+	*(cell_ptr + yobelow) -= 0x02;
+	*(cell_ptr + yobelow + xoright) -= 0x02;
+}
+
+int CellMap::CellState(int x, int y)
+{
+	unsigned char *cell_ptr =
+		cells + (y * width) + x;
+
+	// Return first bit (LSB: cell state stored here)
+	return *cell_ptr & 0x01;
+}
+
+// Copies the rows in [y0, y1) that changed since the last copy to
+// temp_cells, returning the number of bytes copied
+size_t CellMap::SyncRows(unsigned int y0, unsigned int y1)
+{
+	size_t copied = 0;
+
+	for (unsigned int y = y0; y < y1; y++) {
+		if (dirty_rows[y]) {
+			memcpy(temp_cells + y * width, cells + y * width, width);
+			dirty_rows[y] = 0;
+			copied += width;
+		}
+	}
+	return copied;
+}
+
+void CellMap::NextGen()
+{
+	// Bring temp map up to date to keep an unaltered version
+	bytes_copied += SyncRows(0, height);
+
+	NextGenRows(0, height);
+	generations++;
+}
+
+void CellMap::PrintStats()
+{
+	cout << "Bytes copied per generation: " << (generations ? (double)bytes_copied / generations : 0.0)
+		<< " of " << length_in_bytes << endl;
+}
+
+// Processes rows [y0, y1) of temp_cells with the selected kernel
+void CellMap::NextGenRows(unsigned int y0, unsigned int y1)
+{
+	switch (kernel) {
+	case KERNEL_AVX2:
+		NextGenAVX2(y0, y1);
+		break;
+	case KERNEL_SSE2:
+		NextGenSSE2(y0, y1);
+		break;
+	default:
+		NextGenScalar(y0, y1);
+		break;
+	}
+}
+
+bool CellMap::SetRule(const LifeRule& rule)
+{
+	this->rule = rule;
+	conway = rule.IsConway();
+	decay_start = (unsigned char)((rule.states - 2) * CELL_DECAY_STEP);
+	return true;
+}
+
+void CellMap::NextGenScalar(unsigned int y0, unsigned int y1)
+{
+	if (conway)
+		NextGenScalarT<true>(y0, y1);
+	else
+		NextGenScalarT<false>(y0, y1);
+}
+
+template <bool Conway>
+void CellMap::NextGenScalarT(unsigned int y0, unsigned int y1)
+{
+	unsigned int x, y;
+	unsigned int w = width;
+	unsigned char *cell_ptr;
+
+	// Process all cells in the current cell map
+	cell_ptr = temp_cells + y0 * w;
+	for (y = y0; y < y1; y++) {
+
+		bool changed = false;
+		x = 0;
+		do {
+
+			// Zero bytes are off and have no neighbours so skip them...
+			while (*cell_ptr == 0) {
+				cell_ptr++; // Advance to the next cell
+				// If all cells in row are off with no neighbours go to next row
+				if (++x >= w) goto RowDone;
+			}
+
+			// Remaining cells are either on or have neighbours
+			if (ApplyRule<Conway>(x, y, *cell_ptr))
+				changed = true;
+
+			// Advance to the next cell byte
+			cell_ptr++;
+
+		} while (++x < w);
+	RowDone:
+		if (changed)
+			MarkDirty(y);
+	}
+}
+
+// Picks the widest kernel this CPU supports, falling back towards scalar
+void CellMap::SetKernel(Kernel k)
+{
+	if (k == KERNEL_AVX2 && !CpuHasAVX2())
+		k = KERNEL_SSE2;
+	if (k == KERNEL_SSE2 && !CpuHasSSE2())
+		k = KERNEL_SCALAR;
+	kernel = k;
+}
@@ -0,0 +1,170 @@
+// BASED ON MICHAEL ABRASH'S GRAPHICS PROGRAMMING BLACK BOOK CHAPTER 17
+#pragma once
+
+#include "LifeEngine.h"
+#include "Common.h"
+#include "CpuFeatures.h"
+
+#include <cstddef>
+#include <cstdint>
+
+// Cell byte bits counting down the generations a cell has left to die
+// under a Generations rule (0 for cells that are on, or off for good)
+#define CELL_DECAY_MASK 0xE0
+#define CELL_DECAY_STEP 0x20
+
+// CELL STRUCTURE
+/* 
+Cells are stored in 8-bit chars where the 0th bit represents
+the cell state and the 1st to 4th bit represent the number
+of neighbours (up to 8). The 5th to 7th bits are unused by
+Life-like rules.
+Refer to this diagram: http://www.jagregory.com/abrash-black-book/images/17-03.jpg
+
+Under a Generations rule a cell that dies keeps the number of
+generations it has left to die in bits 5-7. It is off, so it adds
+nothing to its neighbours' counts, but its byte is non-zero so the
+loops still visit it; each generation the bits count down by one, and
+a dying cell cannot be born. Cells that are on always have bits 5-7
+clear.
+
+NextGen reads the previous generation from temp_cells while updating
+cells. Rather than copying the whole map to temp_cells every
+generation, CellMap records which rows of cells have been modified
+since the last copy (a cell change touches its row and the rows above
+and below) and copies only those rows.
+
+The rule is applied by looking up the low five bits of the cell byte
+(state and count) in LifeRule::next. The kernels are templates with a
+fast path for Conway's Life that compares counts directly instead.
+*/
+
+// CellMap stores an array of cells with their states. Engines that share
+// the byte layout derive from it; its own loops call AddCell and
+// RemoveCell directly so they stay non-virtual.
+class CellMap : public LifeEngine
+{
+public:
+	CellMap(unsigned int w, unsigned int h);
+	~CellMap();
+	void SetCell(unsigned int x, unsigned int y);
+	void ClearCell(unsigned int x, unsigned int y);
+	void SetCells(const CellCoord* coords, size_t count);
+	void ClearCells(const CellCoord* coords, size_t count);
+	int CellState(int x, int y); // WHY NOT UNSIGNED?
+	void NextGen();
+	void PrintStats();
+	bool SetRule(const LifeRule& rule);
+	void LoadStateBitmap(const uint64_t* bitmap, unsigned int words_per_row); // CellMapBitmap.cpp
+	void SaveStateBitmap(uint64_t* bitmap, unsigned int words_per_row); // CellMapBitmap.cpp
+
+	// NextGen kernels, widest first
+	enum Kernel { KERNEL_SCALAR, KERNEL_SSE2, KERNEL_AVX2 };
+	void SetKernel(Kernel k);
+	Kernel GetKernel() const { return kernel; }
+protected:
+	CellMap(unsigned int w, unsigned int h, bool temp_map);
+	void AddCell(unsigned int x, unsigned int y); // SetCell without marking rows dirty
+	void RemoveCell(unsigned int x, unsigned int y); // ClearCell without marking rows dirty
+	void MarkDirty(unsigned int y);
+	void ChangeCells(const CellCoord* coords, size_t count, bool set);
+	bool ChangeRow(unsigned int y, const CellCoord* run, size_t count, bool set);
+	size_t SyncRows(unsigned int y0, unsigned int y1);
+	bool UpdateCell(unsigned int x, unsigned int y, unsigned char cell);
+	template <bool Conway> bool ApplyRule(unsigned int x, unsigned int y, unsigned char cell);
+	void NextGenRows(unsigned int y0, unsigned int y1);
+	void NextGenScalar(unsigned int y0, unsigned int y1);
+	void NextGenSSE2(unsigned int y0, unsigned int y1); // CellMapSimd.cpp
+	void NextGenAVX2(unsigned int y0, unsigned int y1); // CellMapSimd.cpp
+	template <bool Conway> void NextGenScalarT(unsigned int y0, unsigned int y1);
+	template <bool Conway> void NextGenSSE2T(unsigned int y0, unsigned int y1); // CellMapSimd.cpp
+	template <bool Conway> TARGET_AVX2 void NextGenAVX2T(unsigned int y0, unsigned int y1); // CellMapSimd.cpp
+	bool ApplyMasks(unsigned int x, unsigned int y, uint64_t births, uint64_t deaths, uint64_t decays); // CellMapSimd.cpp
+	void LoadStateBitmapRows(const uint64_t* bitmap, unsigned int words_per_row, unsigned int y0, unsigned int y1); // CellMapBitmap.cpp
+	void EndCell(unsigned int x, unsigned int y);
+	void DecayCell(unsigned int x, unsigned int y);
+	unsigned int DecayColour(unsigned char decay) const;
+
+	Kernel kernel;
+	LifeRule rule;
+	bool conway; // rule is Conway's Life, so the fast paths apply
+	unsigned char decay_start; // Bits 5-7 of a cell that has just died (0 unless a Generations rule)
+	unsigned char* cells;
+	unsigned char* temp_cells;
+	unsigned int length_in_bytes;
+	unsigned char* dirty_rows; // Rows of cells that differ from temp_cells
+	uint64_t bytes_copied; // Bytes copied to temp_cells by NextGen
+	uint64_t generations;
+};
+
+// Records that rows y - 1 to y + 1 (wrapping) may have changed
+inline void CellMap::MarkDirty(unsigned int y)
+{
+	dirty_rows[(y == 0) ? height - 1 : y - 1] = 1;
+	dirty_rows[y] = 1;
+	dirty_rows[(y == height - 1) ? 0 : y + 1] = 1;
+}
+
+// Applies the rule to one cell byte from temp_cells, returning true if
+// the cell changed
+template <bool Conway>
+inline bool CellMap::ApplyRule(unsigned int x, unsigned int y, unsigned char cell)
+{
+	unsigned int count = cell >> 1; // # of neighboring on-cells
+	if (cell & 0x01) {
+
+		// On cell must turn off if not 2 or 3 neighbours (or as the rule says)
+		if (Conway ? (count != 2) && (count != 3) : !rule.next[cell & RULE_INDEX_MASK]) {
+			EndCell(x, y);
+			return true;
+		}
+	}
+	else if (!Conway && (cell & CELL_DECAY_MASK)) {
+
+		// Dying cell counts down, and can't be born until it is off
+		DecayCell(x, y);
+		return true;
+	}
+	else {
+
+		// Off cell must turn on if 3 neighbours (or as the rule says)
+		if (Conway ? count == 3 : rule.next[cell & RULE_INDEX_MASK]) {
+			AddCell(x, y);
+			DrawCell(x, y, ON_COLOUR);
+			return true;
+		}
+	}
+	return false;
+}
+
+// Turns an on cell off. Under a Generations rule it starts dying instead
+inline void CellMap::EndCell(unsigned int x, unsigned int y)
+{
+	RemoveCell(x, y);
+	if (decay_start == 0) {
+		DrawCell(x, y, OFF_COLOUR);
+		return;
+	}
+	cells[y * width + x] |= decay_start;
+	DrawCell(x, y, DecayColour(decay_start));
+}
+
+// Counts a dying cell down a generation
+inline void CellMap::DecayCell(unsigned int x, unsigned int y)
+{
+	unsigned char* cell_ptr = cells + y * width + x;
+	*cell_ptr -= CELL_DECAY_STEP;
+	DrawCell(x, y, DecayColour(*cell_ptr & CELL_DECAY_MASK));
+}
+
+// Dying cells fade from on towards off as their decay bits count down
+inline unsigned int CellMap::DecayColour(unsigned char decay) const
+{
+	return OFF_COLOUR + (ON_COLOUR - OFF_COLOUR) * (decay / CELL_DECAY_STEP) / (rule.states - 1);
+}
+
+// As ApplyRule, for engines that don't specialise on the rule
+inline bool CellMap::UpdateCell(unsigned int x, unsigned int y, unsigned char cell)
+{
+	return conway ? ApplyRule<true>(x, y, cell) : ApplyRule<false>(x, y, cell);
+}
@@ -0,0 +1,140 @@
+// Bulk bitmap load and save for CellMap
+/*
+LoadStateBitmap rebuilds the whole byte map from a state bitmap instead of
+calling SetCell for each live cell, which would add to nine scattered
+bytes per cell. Each word of 64 cells is handled at once, as in
+BitPackedMap: the eight shifted neighbour words are summed with
+bit-parallel full adders into four count bit planes (1s, 2s, 4s, 8s).
+Then every eight cells are spread out to eight cell bytes with one
+table lookup per plane, giving (count << 1) | state for each cell
+directly. A row only depends on the bitmap, so rows are rebuilt on a
+thread pool in any order, and any decay bits are cleared.
+*/
+#include "CellMap.h"
+#include "BitOps.h"
+#include "ThreadPool.h"
+
+#include <cstring>
+
+// Byte j of Spread(v) is bit j of v
+struct SpreadTable
+{
+	SpreadTable()
+	{
+		for (unsigned int v = 0; v < 256; v++) {
+			unsigned char bytes[8];
+			for (unsigned int j = 0; j < 8; j++)
+				bytes[j] = (v >> j) & 1;
+			memcpy(&spread[v], bytes, 8);
+		}
+	}
+	uint64_t spread[256];
+};
+
+static const SpreadTable spread_table;
+
+// Word whose bit b holds the cell to the left of cell b, wrapping the
+// first cell of the row around to the last
+static inline uint64_t West(const uint64_t* row, unsigned int i, unsigned int n, unsigned int last_bit)
+{
+	uint64_t carry = (i == 0) ? row[n - 1] >> last_bit : row[i - 1] >> 63;
+	return (row[i] << 1) | carry;
+}
+
+// Word whose bit b holds the cell to the right of cell b, wrapping the
+// last cell of the row around to the first
+static inline uint64_t East(const uint64_t* row, unsigned int i, unsigned int n, unsigned int last_bit)
+{
+	if (i + 1 < n)
+		return (row[i] >> 1) | (row[i + 1] << 63);
+	return (row[i] >> 1) | ((row[0] & 1) << last_bit);
+}
+
+// Rebuilds the cell bytes of rows [y0, y1) from bitmap
+void CellMap::LoadStateBitmapRows(const uint64_t* bitmap, unsigned int words_per_row, unsigned int y0, unsigned int y1)
+{
+	unsigned int w = width, h = height, n = words_per_row;
+	unsigned int last_bit = (w - 1) % 64;
+	const uint64_t* spread = spread_table.spread;
+
+	for (unsigned int y = y0; y < y1; y++) {
+
+		const uint64_t* row = bitmap + (size_t)y * n;
+		const uint64_t* above = (y == 0) ? bitmap + (size_t)(h - 1) * n : row - n;
+		const uint64_t* below = (y == h - 1) ? bitmap : row + n;
+		unsigned char* cell_ptr = cells + y * w;
+
+		for (unsigned int i = 0; i < n; i++) {
+
+			uint64_t s_above, c_above, s_below, c_below, s_mid, c_mid;
+			uint64_t ones, c_ones, twos_part, c_twos;
+
+			// Sum the three cells above, the three below and the two beside
+			uint64_t west = West(row, i, n, last_bit), east = East(row, i, n, last_bit);
+			FullAdd(West(above, i, n, last_bit), above[i], East(above, i, n, last_bit), s_above, c_above);
+			FullAdd(West(below, i, n, last_bit), below[i], East(below, i, n, last_bit), s_below, c_below);
+			s_mid = west ^ east;
+			c_mid = west & east;
+
+			// Combine into a 4-bit count
+			FullAdd(s_above, s_below, s_mid, ones, c_ones);
+			FullAdd(c_above, c_below, c_mid, twos_part, c_twos);
+			uint64_t twos = twos_part ^ c_ones;
+			uint64_t carry = twos_part & c_ones;
+			uint64_t fours = c_twos ^ carry;
+			uint64_t eights = c_twos & carry;
+
+			// Spread each byte of the planes out to eight cell bytes
+			unsigned int x = i * 64;
+			for (unsigned int shift = 0; shift < 64 && x < w; shift += 8, x += 8) {
+				uint64_t bytes = spread[(row[i] >> shift) & 0xFF]
+					| (spread[(ones >> shift) & 0xFF] << 1)
+					| (spread[(twos >> shift) & 0xFF] << 2)
+					| (spread[(fours >> shift) & 0xFF] << 3)
+					| (spread[(eights >> shift) & 0xFF] << 4);
+				memcpy(cell_ptr + x, &bytes, (x + 8 <= w) ? 8 : w - x);
+			}
+		}
+	}
+}
+
+// Replaces the whole map with the cells in bitmap, whose padding bits
+// must be 0. The map doesn't need to be clear
+void CellMap::LoadStateBitmap(const uint64_t* bitmap, unsigned int words_per_row)
+{
+	ThreadPool pool(0);
+	unsigned int chunks = pool.ThreadCount() * 4;
+	if (chunks > height)
+		chunks = height;
+
+	TaskGroup group;
+	for (unsigned int c = 0; c < chunks; c++) {
+		unsigned int y0 = (unsigned int)((unsigned long long)height * c / chunks);
+		unsigned int y1 = (unsigned int)((unsigned long long)height * (c + 1) / chunks);
+		pool.Submit(group, [=] { LoadStateBitmapRows(bitmap, words_per_row, y0, y1); });
+	}
+	pool.Wait(group);
+
+	// Every row differs from temp_cells now
+	memset(dirty_rows, 1, height);
+}
+
+// Gathers bit 0 of every cell byte, eight at a time: masking leaves one
+// bit per byte, and the multiply moves bit 0 of byte j to bit 56 + j
+// (little-endian loads)
+void CellMap::SaveStateBitmap(uint64_t* bitmap, unsigned int words_per_row)
+{
+	unsigned int w = width;
+
+	for (unsigned int y = 0; y < height; y++) {
+		const unsigned char* cell_ptr = cells + y * w;
+		uint64_t* row = bitmap + (size_t)y * words_per_row;
+		memset(row, 0, words_per_row * sizeof(uint64_t));
+		for (unsigned int x = 0; x < w; x += 8) {
+			uint64_t bytes = 0;
+			memcpy(&bytes, cell_ptr + x, (x + 8 <= w) ? 8 : w - x);
+			uint64_t states = ((bytes & 0x0101010101010101ULL) * 0x0102040810204080ULL) >> 56;
+			row[x / 64] |= states << (x % 64);
+		}
+	}
+}
@@ -0,0 +1,236 @@
+// SIMD NextGen kernels for CellMap
+/*
+Each kernel loads 16 (SSE2) or 32 (AVX2) cell bytes from temp_cells at
+once. With bits 5-7 unused a cell byte is exactly (count << 1) | state,
+so the rules reduce to byte compares:
+	birth: byte == 0x06 (off, 3 neighbours)
+	death: byte is odd and not 0x05 or 0x07 (on, not 2 or 3 neighbours)
+Other rules compare against every birth and survival byte of the rule
+instead; the kernels are templates so Conway's Life keeps the fixed
+compares. Under a Generations rule dying cells have bits 5-7 set, so
+they never equal a birth byte; a third mask picks them out to count
+down. The compare results are packed into bit masks and only the set bits are
+visited, so runs of quiet cells cost one load and two compares per block.
+The last partial block of a row is copied into a zero padded buffer;
+zero bytes never change. Rows with any change are marked dirty.
+*/
+#include "CellMap.h"
+#include "BitOps.h"
+#include "Common.h"
+#include "CpuFeatures.h"
+
+#include <cstring>
+
+#if CPU_X86
+#include <immintrin.h>
+#endif
+
+// Applies the births, deaths and decays found in a block starting at
+// (x, y), returning true if there were any
+inline bool CellMap::ApplyMasks(unsigned int x, unsigned int y, uint64_t births, uint64_t deaths, uint64_t decays)
+{
+	bool changed = (births | deaths | decays) != 0;
+
+	while (births) {
+		unsigned int cx = x + LowestBit(births);
+		AddCell(cx, y);
+		DrawCell(cx, y, ON_COLOUR);
+		births &= births - 1;
+	}
+	while (deaths) {
+		unsigned int cx = x + LowestBit(deaths);
+		EndCell(cx, y);
+		deaths &= deaths - 1;
+	}
+	while (decays) {
+		DecayCell(x + LowestBit(decays), y);
+		decays &= decays - 1;
+	}
+	return changed;
+}
+
+#if CPU_X86
+
+// Fills bytes with the cell bytes (count << 1 | state) for each count set
+// in counts, returning how many there are
+static unsigned int RuleBytes(unsigned int counts, unsigned int state, unsigned char bytes[9])
+{
+	unsigned int n = 0;
+	for (unsigned int count = 0; count <= 8; count++) {
+		if ((counts >> count) & 1)
+			bytes[n++] = (unsigned char)((count << 1) | state);
+	}
+	return n;
+}
+
+void CellMap::NextGenSSE2(unsigned int y0, unsigned int y1)
+{
+	if (conway)
+		NextGenSSE2T<true>(y0, y1);
+	else
+		NextGenSSE2T<false>(y0, y1);
+}
+
+void CellMap::NextGenAVX2(unsigned int y0, unsigned int y1)
+{
+	if (conway)
+		NextGenAVX2T<true>(y0, y1);
+	else
+		NextGenAVX2T<false>(y0, y1);
+}
+
+template <bool Conway>
+void CellMap::NextGenSSE2T(unsigned int y0, unsigned int y1)
+{
+	unsigned int x, y, i;
+	unsigned int w = width;
+	unsigned char *row_ptr;
+	alignas(16) unsigned char tail[16];
+	const __m128i one = _mm_set1_epi8(0x01);
+	const __m128i birth = _mm_set1_epi8(0x06);
+	const __m128i stay2 = _mm_set1_epi8(0x05);
+	const __m128i stay3 = _mm_set1_epi8(0x07);
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i decay = _mm_set1_epi8((char)CELL_DECAY_MASK);
+	const bool generations = (decay_start != 0);
+	unsigned char bytes[9];
+	__m128i birth_bytes[9], stay_bytes[9];
+	unsigned int births_n = RuleBytes(rule.birth, 0, bytes);
+	for (i = 0; i < births_n; i++)
+		birth_bytes[i] = _mm_set1_epi8((char)bytes[i]);
+	unsigned int stays_n = RuleBytes(rule.survive, 1, bytes);
+	for (i = 0; i < stays_n; i++)
+		stay_bytes[i] = _mm_set1_epi8((char)bytes[i]);
+
+	for (y = y0; y < y1; y++) {
+
+		bool changed = false;
+		row_ptr = temp_cells + y * w;
+		for (x = 0; x < w; x += 16) {
+
+			__m128i v;
+			if (x + 16 <= w)
+				v = _mm_loadu_si128((const __m128i*)(row_ptr + x));
+			else {
+				memset(tail, 0, sizeof(tail));
+				memcpy(tail, row_ptr + x, w - x);
+				v = _mm_load_si128((const __m128i*)tail);
+			}
+
+			// Skip blocks of cells that are off with no neighbours
+			if (_mm_movemask_epi8(_mm_cmpeq_epi8(v, zero)) == 0xFFFF)
+				continue;
+
+			__m128i alive = _mm_cmpeq_epi8(_mm_and_si128(v, one), one);
+			__m128i born, stays;
+			if (Conway) {
+				born = _mm_cmpeq_epi8(v, birth);
+				stays = _mm_or_si128(_mm_cmpeq_epi8(v, stay2), _mm_cmpeq_epi8(v, stay3));
+			}
+			else {
+				born = stays = zero;
+				for (i = 0; i < births_n; i++)
+					born = _mm_or_si128(born, _mm_cmpeq_epi8(v, birth_bytes[i]));
+				for (i = 0; i < stays_n; i++)
+					stays = _mm_or_si128(stays, _mm_cmpeq_epi8(v, stay_bytes[i]));
+			}
+			uint64_t births = (unsigned int)_mm_movemask_epi8(born);
+			uint64_t deaths = (unsigned int)_mm_movemask_epi8(_mm_andnot_si128(stays, alive));
+			uint64_t decays = 0;
+			if (!Conway && generations)
+				decays = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(v, decay), zero)) ^ 0xFFFF;
+
+			if (ApplyMasks(x, y, births, deaths, decays))
+				changed = true;
+		}
+		if (changed)
+			MarkDirty(y);
+	}
+}
+
+template <bool Conway>
+TARGET_AVX2 void CellMap::NextGenAVX2T(unsigned int y0, unsigned int y1)
+{
+	unsigned int x, y, i;
+	unsigned int w = width;
+	unsigned char *row_ptr;
+	alignas(32) unsigned char tail[32];
+	const __m256i one = _mm256_set1_epi8(0x01);
+	const __m256i birth = _mm256_set1_epi8(0x06);
+	const __m256i stay2 = _mm256_set1_epi8(0x05);
+	const __m256i stay3 = _mm256_set1_epi8(0x07);
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i decay = _mm256_set1_epi8((char)CELL_DECAY_MASK);
+	const bool generations = (decay_start != 0);
+	unsigned char bytes[9];
+	__m256i birth_bytes[9], stay_bytes[9];
+	unsigned int births_n = RuleBytes(rule.birth, 0, bytes);
+	for (i = 0; i < births_n; i++)
+		birth_bytes[i] = _mm256_set1_epi8((char)bytes[i]);
+	unsigned int stays_n = RuleBytes(rule.survive, 1, bytes);
+	for (i = 0; i < stays_n; i++)
+		stay_bytes[i] = _mm256_set1_epi8((char)bytes[i]);
+
+	for (y = y0; y < y1; y++) {
+
+		bool changed = false;
+		row_ptr = temp_cells + y * w;
+		for (x = 0; x < w; x += 32) {
+
+			__m256i v;
+			if (x + 32 <= w)
+				v = _mm256_loadu_si256((const __m256i*)(row_ptr + x));
+			else {
+				memset(tail, 0, sizeof(tail));
+				memcpy(tail, row_ptr + x, w - x);
+				v = _mm256_load_si256((const __m256i*)tail);
+			}
+
+			// Skip blocks of cells that are off with no neighbours
+			if (_mm256_testz_si256(v, v))
+				continue;
+
+			__m256i alive = _mm256_cmpeq_epi8(_mm256_and_si256(v, one), one);
+			__m256i born, stays;
+			if (Conway) {
+				born = _mm256_cmpeq_epi8(v, birth);
+				stays = _mm256_or_si256(_mm256_cmpeq_epi8(v, stay2), _mm256_cmpeq_epi8(v, stay3));
+			}
+			else {
+				born = stays = zero;
+				for (i = 0; i < births_n; i++)
+					born = _mm256_or_si256(born, _mm256_cmpeq_epi8(v, birth_bytes[i]));
+				for (i = 0; i < stays_n; i++)
+					stays = _mm256_or_si256(stays, _mm256_cmpeq_epi8(v, stay_bytes[i]));
+			}
+			uint64_t births = (unsigned int)_mm256_movemask_epi8(born);
+			uint64_t deaths = (unsigned int)_mm256_movemask_epi8(_mm256_andnot_si256(stays, alive));
+			uint64_t decays = 0;
+			if (!Conway && generations)
+				decays = (unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_and_si256(v, decay), zero)) ^ 0xFFFFFFFF;
+
+			if (ApplyMasks(x, y, births, deaths, decays))
+				changed = true;
+		}
+		if (changed)
+			MarkDirty(y);
+	}
+
+	// Avoid AVX-SSE transition penalties in the code that follows
+	_mm256_zeroupper();
+}
+
+#else
+
+// Not reachable: SetKernel never selects these without x86 SIMD
+void CellMap::NextGenSSE2(unsigned int y0, unsigned int y1)
+{
+	NextGenScalar(y0, y1);
+}
+
+void CellMap::NextGenAVX2(unsigned int y0, unsigned int y1)
+{
+	NextGenScalar(y0, y1);
+}
+
+#endif
@@ -0,0 +1,140 @@
+// BASED ON MICHAEL ABRASH'S GRAPHICS PROGRAMMING BLACK BOOK CHAPTER 18
+#include "ChangeListMap.h"
+#include "BitOps.h"
+#include "Common.h"
+
+#include <iostream>
+
+using namespace std;
+
+ChangeListMap::ChangeListMap(unsigned int w, unsigned int h) : CellMap(w, h)
+{
+	cells_changed = 0;
+	cells_checked = 0;
+}
+
+void ChangeListMap::SetCell(unsigned int x, unsigned int y)
+{
+	CellMap::SetCell(x, y);
+	change_list.push_back(y * width + x);
+}
+
+void ChangeListMap::ClearCell(unsigned int x, unsigned int y)
+{
+	CellMap::ClearCell(x, y);
+	change_list.push_back(y * width + x);
+}
+
+// Cells that were already in the state asked for are listed too, which
+// only costs a check
+void ChangeListMap::SetCells(const CellCoord* coords, size_t count)
+{
+	CellMap::SetCells(coords, count);
+	for (size_t i = 0; i < count; i++)
+		change_list.push_back(coords[i].y * width + coords[i].x);
+}
+
+void ChangeListMap::ClearCells(const CellCoord* coords, size_t count)
+{
+	CellMap::ClearCells(coords, count);
+	for (size_t i = 0; i < count; i++)
+		change_list.push_back(coords[i].y * width + coords[i].x);
+}
+
+// Only live cells and their neighbours can change (there is no B0), so
+// the change list starts as every live cell
+void ChangeListMap::LoadStateBitmap(const uint64_t* bitmap, unsigned int words_per_row)
+{
+	CellMap::LoadStateBitmap(bitmap, words_per_row);
+	change_list.clear();
+	for (unsigned int y = 0; y < height; y++) {
+		const uint64_t* row = bitmap + (size_t)y * words_per_row;
+		for (unsigned int i = 0; i < words_per_row; i++) {
+			uint64_t word = row[i];
+			while (word) {
+				change_list.push_back(y * width + i * 64 + LowestBit(word));
+				word &= word - 1;
+			}
+		}
+	}
+}
+
+bool ChangeListMap::SetRule(const LifeRule& rule)
+{
+	if (rule.states != 2)
+		return false;
+	return CellMap::SetRule(rule);
+}
+
+// Queues the cell at offset i to flip if the rules say it changes
+inline void ChangeListMap::Check(unsigned int i)
+{
+	unsigned char cell = cells[i];
+	if (cell & CELL_QUEUED)
+		return;
+	cells[i] = cell | CELL_QUEUED;
+	checked.push_back(i);
+
+	// Flips if the rule gives a different state
+	if (rule.next[cell & RULE_INDEX_MASK] != (cell & 0x01))
+		next_list.push_back(i);
+}
+
+void ChangeListMap::NextGen()
+{
+	unsigned int w = width, h = height;
+	size_t n;
+
+	// Check every cell that changed and its neighbours
+	next_list.clear();
+	for (n = 0; n < change_list.size(); n++) {
+		unsigned int i = change_list[n];
+		unsigned int x = i % w, y = i / w;
+
+		// Offsets to the eight neighbouring cells, wrapping at the edges
+		int xoleft = (x == 0) ? w - 1 : -1;
+		int xoright = (x == (w - 1)) ? -(int)(w - 1) : 1;
+		int yoabove = (y == 0) ? length_in_bytes - w : -(int)w;
+		int yobelow = (y == (h - 1)) ? -(int)(length_in_bytes - w) : w;
+
+		Check(i + yoabove + xoleft);
+		Check(i + yoabove);
+		Check(i + yoabove + xoright);
+		Check(i + xoleft);
+		Check(i);
+		Check(i + xoright);
+		Check(i + yobelow + xoleft);
+		Check(i + yobelow);
+		Check(i + yobelow + xoright);
+	}
+
+	cells_checked += checked.size();
+	for (n = 0; n < checked.size(); n++)
+		cells[checked[n]] &= ~CELL_QUEUED;
+	checked.clear();
+
+	// Flip the cells; these are next generation's change list
+	for (n = 0; n < next_list.size(); n++) {
+		unsigned int i = next_list[n];
+		unsigned int x = i % w, y = i / w;
+		if (cells[i] & 0x01) {
+			RemoveCell(x, y);
+			DrawCell(x, y, OFF_COLOUR);
+		}
+		else {
+			AddCell(x, y);
+			DrawCell(x, y, ON_COLOUR);
+		}
+	}
+
+	change_list.swap(next_list);
+	cells_changed += change_list.size();
+	generations++;
+}
+
+// temp_cells is never used, so unlike CellMap there are no bytes copied to report
+void ChangeListMap::PrintStats()
+{
+	cout << "Average cells changed: " << (generations ? (double)cells_changed / generations : 0.0)
+		<< "\nAverage cells checked: " << (generations ? (double)cells_checked / generations : 0.0) << endl;
+}
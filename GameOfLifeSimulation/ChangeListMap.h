@@ -0,0 +1,48 @@
+// BASED ON MICHAEL ABRASH'S GRAPHICS PROGRAMMING BLACK BOOK CHAPTER 18
+#pragma once
+
+#include "CellMap.h"
+
+#include <cstdint>
+#include <vector>
+
+// Cell byte flag (bit 5) marking a cell already checked this generation.
+// It shares the bit with CELL_DECAY_MASK, so Generations rules are refused
+#define CELL_QUEUED 0x20
+
+// CHANGE LIST STRUCTURE
+/*
+Cells use the CellMap byte layout. Only a cell that changed last
+generation, or a neighbour of one, can change this generation, so
+NextGen visits just those cells instead of the whole map:
+	1. For each cell on the change list and its eight neighbours, check
+	   the rules once (CELL_QUEUED stops a cell being checked twice) and
+	   put the cells that will flip on the next change list.
+	2. Clear the CELL_QUEUED flags.
+	3. Flip every cell on the next change list with SetCell/ClearCell.
+Because nothing is flipped until every cell has been checked, no
+temp_cells copy is needed.
+*/
+
+// ChangeListMap is a CellMap whose work is proportional to the cells that change
+class ChangeListMap final : public CellMap
+{
+public:
+	ChangeListMap(unsigned int w, unsigned int h);
+	void SetCell(unsigned int x, unsigned int y);
+	void ClearCell(unsigned int x, unsigned int y);
+	void SetCells(const CellCoord* coords, size_t count);
+	void ClearCells(const CellCoord* coords, size_t count);
+	void LoadStateBitmap(const uint64_t* bitmap, unsigned int words_per_row);
+	void NextGen();
+	void PrintStats();
+	bool SetRule(const LifeRule& rule);
+private:
+	void Check(unsigned int i);
+
+	std::vector<unsigned int> change_list; // Cells (as offsets) changed since the last NextGen
+	std::vector<unsigned int> next_list; // Cells to flip this generation
+	std::vector<unsigned int> checked; // Cells flagged CELL_QUEUED
+	uint64_t cells_changed;
+	uint64_t cells_checked;
+};
@@ -0,0 +1,14 @@
+// Declarations shared between main.cpp and the simulation engines
+#pragma once
+
+#define OFF_COLOUR 0x00
+#define ON_COLOUR 0xFF
+
+// Randomisation seed
+extern unsigned int seed;
+
+// Fraction of cells Init turns on
+extern double density;
+
+// Draws a single cell onto the window surface (defined in main.cpp)
+void DrawCell(unsigned int x, unsigned int y, unsigned int colour);
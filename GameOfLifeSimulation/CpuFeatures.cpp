@@ -0,0 +1,64 @@
+#include "CpuFeatures.h"
+
+#if CPU_X86
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+#if CPU_X86
+// Fills regs with EAX, EBX, ECX, EDX for the given CPUID leaf
+static void Cpuid(unsigned int leaf, unsigned int sub_leaf, unsigned int regs[4])
+{
+#ifdef _MSC_VER
+	__cpuidex((int*)regs, leaf, sub_leaf);
+#else
+	__cpuid_count(leaf, sub_leaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+// Low 32 bits of extended control register 0 (which register states the OS saves)
+static unsigned int Xgetbv0()
+{
+#ifdef _MSC_VER
+	return (unsigned int)_xgetbv(0);
+#else
+	unsigned int eax, edx;
+	__asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+	return eax;
+#endif
+}
+#endif
+
+bool CpuHasSSE2()
+{
+#if CPU_X86
+	unsigned int regs[4];
+	Cpuid(1, 0, regs);
+	return (regs[3] & (1 << 26)) != 0;
+#else
+	return false;
+#endif
+}
+
+bool CpuHasAVX2()
+{
+#if CPU_X86
+	unsigned int regs[4];
+	Cpuid(0, 0, regs);
+	if (regs[0] < 7)
+		return false;
+
+	// The OS must also save the YMM registers (OSXSAVE set, XCR0 bits 1 and 2)
+	Cpuid(1, 0, regs);
+	if ((regs[2] & (1 << 27)) == 0 || (Xgetbv0() & 0x6) != 0x6)
+		return false;
+
+	Cpuid(7, 0, regs);
+	return (regs[1] & (1 << 5)) != 0;
+#else
+	return false;
+#endif
+}
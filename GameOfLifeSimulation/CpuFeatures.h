@@ -0,0 +1,19 @@
+// Runtime CPU feature detection for picking SIMD kernels
+#pragma once
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define CPU_X86 1
+#else
+#define CPU_X86 0
+#endif
+
+// GCC and Clang only emit AVX2 instructions in functions marked for it;
+// MSVC allows the intrinsics anywhere
+#if defined(__GNUC__) && CPU_X86
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TARGET_AVX2
+#endif
+
+bool CpuHasSSE2();
+bool CpuHasAVX2();
@@ -0,0 +1,183 @@
+// BASED ON MICHAEL ABRASH'S GRAPHICS PROGRAMMING BLACK BOOK CHAPTER 17
+#include "HaloMap.h"
+#include "Common.h"
+
+#include <cstdint>
+#include <cstring>
+
+// Rounds a pointer up to a multiple of HALO_ALIGN
+static unsigned char* Align(unsigned char* p)
+{
+	return (unsigned char*)(((uintptr_t)p + HALO_ALIGN - 1) & ~(uintptr_t)(HALO_ALIGN - 1));
+}
+
+HaloMap::HaloMap(unsigned int w, unsigned int h, Boundary boundary) : LifeEngine(w, h)
+{
+	this->boundary = boundary;
+	stride = (w + 2 + HALO_ALIGN - 1) / HALO_ALIGN * HALO_ALIGN;
+	length_in_bytes = stride * (h + 2);
+	cells_alloc = new unsigned char[length_in_bytes + HALO_ALIGN];  // cell storage
+	temp_alloc = new unsigned char[length_in_bytes + HALO_ALIGN]; // temp cell storage
+	cells = Align(cells_alloc);
+	temp_cells = Align(temp_alloc);
+	memset(cells, 0, length_in_bytes);  // clear all cells, to start
+}
+
+HaloMap::~HaloMap()
+{
+	delete[] cells_alloc;
+	delete[] temp_alloc;
+}
+
+void HaloMap::SetCell(unsigned int x, unsigned int y)
+{
+	int s = stride;
+	unsigned char *cell_ptr = cells + (y + 1) * s + x + 1;
+
+	*(cell_ptr) |= 0x01; // Set first bit to 1
+
+	// Change successive bits for neighbour counts
+	*(cell_ptr - s - 1) += 0x02;
+	*(cell_ptr - s) += 0x02;
+	*(cell_ptr - s + 1) += 0x02;
+	*(cell_ptr - 1) += 0x02;
+	*(cell_ptr + 1) += 0x02;
+	*(cell_ptr + s - 1) += 0x02;
+	*(cell_ptr + s) += 0x02;
+	*(cell_ptr + s + 1) += 0x02;
+}
+
+void HaloMap::ClearCell(unsigned int x, unsigned int y)
+{
+	int s = stride;
+	unsigned char *cell_ptr = cells + (y + 1) * s + x + 1;
+
+	*(cell_ptr) &= ~0x01; // Set first bit to 0
+
+	// Change successive bits for neighbour counts
+	*(cell_ptr - s - 1) -= 0x02;
+	*(cell_ptr - s) -= 0x02;
+	*(cell_ptr - s + 1) -= 0x02;
+	*(cell_ptr - 1) -= 0x02;
+	*(cell_ptr + 1) -= 0x02;
+	*(cell_ptr + s - 1) -= 0x02;
+	*(cell_ptr + s) -= 0x02;
+	*(cell_ptr + s + 1) -= 0x02;
+}
+
+int HaloMap::CellState(int x, int y)
+{
+	// Return first bit (LSB: cell state stored here)
+	return cells[(y + 1) * stride + x + 1] & 0x01;
+}
+
+bool HaloMap::SetRule(const LifeRule& rule)
+{
+	if (rule.states != 2)
+		return false; // No dying states in this engine
+	this->rule = rule;
+	return true;
+}
+
+// The real cell that ghost cell (x, y) stands for, or NULL if it is dead
+unsigned char* HaloMap::Image(int x, int y)
+{
+	int w = width, h = height;
+
+	switch (boundary) {
+	case BOUNDARY_TORUS:
+		x = (x + w) % w;
+		y = (y + h) % h;
+		break;
+	case BOUNDARY_KLEIN:
+		x = (x + w) % w;
+		if (y < 0 || y >= h) {
+			x = w - 1 - x;
+			y = (y + h) % h;
+		}
+		break;
+	case BOUNDARY_MIRROR:
+		x = (x < 0) ? 0 : (x >= w) ? w - 1 : x;
+		y = (y < 0) ? 0 : (y >= h) ? h - 1 : y;
+		break;
+	default:
+		return NULL;
+	}
+	return cells + (y + 1) * stride + x + 1;
+}
+
+// Moves the counts in ghost cell (x, y) to the cell it stands for
+inline void HaloMap::FoldGhost(int x, int y)
+{
+	unsigned char* ghost = cells + (y + 1) * stride + x + 1;
+	if (*ghost == 0)
+		return;
+
+	unsigned char* image = Image(x, y);
+	if (image != NULL)
+		*image += *ghost;
+	*ghost = 0;
+}
+
+void HaloMap::FoldHalo()
+{
+	int w = width, h = height;
+	int x, y;
+
+	for (x = -1; x <= w; x++) {
+		FoldGhost(x, -1);
+		FoldGhost(x, h);
+	}
+	for (y = 0; y < h; y++) {
+		FoldGhost(-1, y);
+		FoldGhost(w, y);
+	}
+}
+
+void HaloMap::NextGen()
+{
+	unsigned int x, y;
+	unsigned int w = width;
+	unsigned char *cell_ptr;
+
+	// Counts only ever reach the border through SetCell and ClearCell, so
+	// folding it back now leaves it clear for the copy below
+	FoldHalo();
+
+	// Copy to temp map to keep an unaltered version
+	memcpy(temp_cells, cells, length_in_bytes);
+
+	// Process all cells in the current cell map
+	for (y = 0; y < height; y++) {
+
+		cell_ptr = temp_cells + (y + 1) * stride + 1;
+		x = 0;
+		do {
+
+			// Zero bytes are off and have no neighbours so skip them...
+			while (*cell_ptr == 0) {
+				cell_ptr++; // Advance to the next cell
+				// If all cells in row are off with no neighbours go to next row
+				if (++x >= w) goto RowDone;
+			}
+
+			// Remaining cells are either on or have neighbours; flip them
+			// if the rule gives a different state
+			if (rule.next[*cell_ptr & RULE_INDEX_MASK] != (*cell_ptr & 0x01)) {
+				if (*cell_ptr & 0x01) {
+					ClearCell(x, y);
+					DrawCell(x, y, OFF_COLOUR);
+				}
+				else {
+					SetCell(x, y);
+					DrawCell(x, y, ON_COLOUR);
+				}
+			}
+
+			// Advance to the next cell byte
+			cell_ptr++;
+
+		} while (++x < w);
+	RowDone:;
+	}
+}
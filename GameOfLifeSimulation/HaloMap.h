@@ -0,0 +1,59 @@
+// BASED ON MICHAEL ABRASH'S GRAPHICS PROGRAMMING BLACK BOOK CHAPTER 17
+#pragma once
+
+#include "LifeEngine.h"
+
+// Row stride of the halo map is rounded up to a multiple of this (a cache line)
+#define HALO_ALIGN 64
+
+// What lies beyond the edges of the map
+enum Boundary
+{
+	BOUNDARY_TORUS, // Wrap around both ways
+	BOUNDARY_DEAD, // Dead cells
+	BOUNDARY_KLEIN, // Wrap around, mirrored left to right across the top and bottom edges
+	BOUNDARY_MIRROR // Reflection of the edge cells
+};
+
+// HALO STRUCTURE
+/*
+Cells use the CellMap byte layout, but the map is stored with a one
+cell ghost border: cell (x, y) is at (y + 1) * stride + x + 1, with
+stride the width plus two rounded up to HALO_ALIGN, and each row
+starting HALO_ALIGN aligned. Every cell then has all eight neighbours
+at fixed offsets, so SetCell and ClearCell update the counts without
+any wraparound tests.
+
+Counts that land in the border belong to the real cell that the ghost
+cell stands for under the boundary policy. Once per generation, before
+the map is copied to temp_cells, each ghost byte is added to that cell
+and cleared (or just cleared, for dead edges). This works for any
+policy that maps a ghost cell to a fixed real cell, as the neighbour
+relation it gives is symmetric.
+*/
+
+// HaloMap is a CellMap with a ghost border and selectable edges
+class HaloMap final : public LifeEngine
+{
+public:
+	HaloMap(unsigned int w, unsigned int h, Boundary boundary);
+	~HaloMap();
+	void SetCell(unsigned int x, unsigned int y);
+	void ClearCell(unsigned int x, unsigned int y);
+	int CellState(int x, int y);
+	void NextGen();
+	bool SetRule(const LifeRule& rule);
+private:
+	unsigned char* Image(int x, int y);
+	void FoldHalo();
+	void FoldGhost(int x, int y);
+
+	Boundary boundary;
+	LifeRule rule;
+	unsigned int stride;
+	unsigned int length_in_bytes; // Including the border
+	unsigned char* cells_alloc;
+	unsigned char* temp_alloc;
+	unsigned char* cells; // Aligned start of the map, at ghost cell (-1, -1)
+	unsigned char* temp_cells;
+};
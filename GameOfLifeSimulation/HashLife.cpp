@@ -0,0 +1,680 @@
+// BASED ON BILL GOSPER'S HASHLIFE ALGORITHM
+#include "HashLife.h"
+#include "Common.h"
+
+#include <iostream>
+
+using namespace std;
+
+// Initial number of hash buckets in each segment (must be a power of 2)
+#define HASH_INITIAL_BUCKETS (1 << 10)
+
+#define SLAB_SIZE (1 << HASHLIFE_SLAB_BITS)
+#define MAX_SLABS (1 << (32 - HASHLIFE_SLAB_BITS))
+
+// Marks an empty hash chain or a missing result
+#define NO_NODE 0xFFFFFFFF
+// The two cells occupy the first arena slots
+#define DEAD_CELL 0
+#define LIVE_CELL 1
+
+// Hashes the four quadrant indices of a node
+static inline uint64_t HashQuadrants(uint32_t nw, uint32_t ne, uint32_t sw, uint32_t se)
+{
+	uint64_t h = ((uint64_t)nw << 32) | ne;
+	h = h * 0x9E3779B97F4A7C15ULL + (((uint64_t)sw << 32) | se);
+	h ^= h >> 29;
+	h *= 0xBF58476D1CE4E5B9ULL;
+	h ^= h >> 32;
+	return h;
+}
+
+// Segment of the hash table a node with the given hash lives in
+static inline unsigned int SegmentOf(uint64_t h)
+{
+	return (unsigned int)(h >> 58) % HASH_SEGMENTS;
+}
+
+HashLife::HashLife(unsigned int threads)
+{
+	slabs = new Node*[MAX_SLABS];
+	slab_count = 0;
+	next_free = 0;
+
+	for (int i = 0; i < HASH_SEGMENTS; i++) {
+		segments[i].buckets.assign(HASH_INITIAL_BUCKETS, NO_NODE);
+		segments[i].count = 0;
+	}
+	node_count = 0;
+	generation = 0;
+	pool = (threads == 1) ? NULL : new ThreadPool(threads);
+
+	budget_nodes = ((size_t)HASHLIFE_DEFAULT_BUDGET_MB << 20) / sizeof(Node);
+	enforce_budget = false;
+	over_budget = false;
+	nodes_freed = 0;
+	collections = 0;
+	cache_hits = 0;
+	cache_misses = 0;
+
+	// Cells are not hashed; they are the first two nodes allocated
+	for (int i = 0; i < 2; i++) {
+		Node& cell = At(Allocate());
+		cell.nw = cell.ne = cell.sw = cell.se = NO_NODE;
+		cell.result = NO_NODE;
+		cell.result_step = -1;
+		cell.next = NO_NODE;
+		cell.level = 0;
+		cell.marked = false;
+		cell.population = i;
+	}
+
+	// Empty nodes are built up front so lookups need no locking
+	empty_nodes[0] = DEAD_CELL;
+	for (int level = 1; level <= HASHLIFE_MAX_LEVEL + 1; level++) {
+		NodeId e = empty_nodes[level - 1];
+		empty_nodes[level] = Find(e, e, e, e);
+	}
+	root = EmptyNode(3);
+}
+
+HashLife::~HashLife()
+{
+	delete pool;
+
+	for (unsigned int i = 0; i < slab_count; i++)
+		delete[] slabs[i];
+	delete[] slabs;
+}
+
+// Takes a node from the free list, or the arena, adding a slab if full
+HashLife::NodeId HashLife::Allocate()
+{
+	lock_guard<mutex> guard(alloc_lock);
+
+	if (!free_nodes.empty()) {
+		NodeId id = free_nodes.back();
+		free_nodes.pop_back();
+		return id;
+	}
+
+	if ((next_free >> HASHLIFE_SLAB_BITS) == slab_count)
+		slabs[slab_count++] = new Node[SLAB_SIZE];
+	return next_free++;
+}
+
+// Returns the canonical node with the given quadrants, creating it if needed
+HashLife::NodeId HashLife::Find(NodeId nw, NodeId ne, NodeId sw, NodeId se)
+{
+	uint64_t h = HashQuadrants(nw, ne, sw, se);
+	Segment& segment = segments[SegmentOf(h)];
+
+	// Locking is only needed while tasks are running on the pool
+	unique_lock<mutex> guard(segment.lock, defer_lock);
+	if (pool)
+		guard.lock();
+
+	size_t slot = (size_t)h & (segment.buckets.size() - 1);
+	for (NodeId id = segment.buckets[slot]; id != NO_NODE; id = At(id).next) {
+		Node& n = At(id);
+		if (n.nw == nw && n.ne == ne && n.sw == sw && n.se == se)
+			return id;
+	}
+
+	NodeId id = Allocate();
+	Node& n = At(id);
+	n.nw = nw;
+	n.ne = ne;
+	n.sw = sw;
+	n.se = se;
+	n.result.store(NO_NODE, memory_order_relaxed);
+	n.result_step.store(-1, memory_order_relaxed);
+	n.level = At(nw).level + 1;
+	n.marked = false;
+	n.population = At(nw).population + At(ne).population + At(sw).population + At(se).population;
+	n.next = segment.buckets[slot];
+	segment.buckets[slot] = id;
+	if (node_count.fetch_add(1, memory_order_relaxed) >= budget_nodes && enforce_budget)
+		over_budget.store(true, memory_order_relaxed);
+
+	// Keep chains short
+	if (++segment.count > segment.buckets.size())
+		Rehash(segment);
+
+	return id;
+}
+
+// Doubles a segment's buckets (segment lock held)
+void HashLife::Rehash(Segment& segment)
+{
+	vector<NodeId> old_buckets(segment.buckets.size() * 2, NO_NODE);
+	old_buckets.swap(segment.buckets);
+
+	for (size_t i = 0; i < old_buckets.size(); i++) {
+		NodeId id = old_buckets[i];
+		while (id != NO_NODE) {
+			Node& n = At(id);
+			NodeId next = n.next;
+			size_t slot = (size_t)HashQuadrants(n.nw, n.ne, n.sw, n.se) & (segment.buckets.size() - 1);
+			n.next = segment.buckets[slot];
+			segment.buckets[slot] = id;
+			id = next;
+		}
+	}
+}
+
+HashLife::NodeId HashLife::EmptyNode(int level)
+{
+	return empty_nodes[level];
+}
+
+// Level n-1 node at the centre of a level n node
+HashLife::NodeId HashLife::Centre(NodeId id)
+{
+	Node& n = At(id);
+	return Find(At(n.nw).se, At(n.ne).sw, At(n.sw).ne, At(n.se).nw);
+}
+
+// Level n node straddling the border between two side by side level n nodes
+HashLife::NodeId HashLife::HorizontalCentre(NodeId w, NodeId e)
+{
+	return Find(At(w).ne, At(e).nw, At(w).se, At(e).sw);
+}
+
+// Level n node straddling the border between two stacked level n nodes
+HashLife::NodeId HashLife::VerticalCentre(NodeId n, NodeId s)
+{
+	return Find(At(n).sw, At(n).se, At(s).nw, At(s).ne);
+}
+
+// Centre 2x2 of a level 2 node advanced one generation by brute force
+HashLife::NodeId HashLife::BaseResult(NodeId id)
+{
+	unsigned int bits = 0, x, y;
+	Node& n = At(id);
+	NodeId quads[4] = { n.nw, n.ne, n.sw, n.se };
+	NodeId next[4];
+
+	// Gather the 4x4 cells into a 16-bit grid, bit (y * 4 + x)
+	for (y = 0; y < 4; y++) {
+		for (x = 0; x < 4; x++) {
+			Node& q = At(quads[(y >> 1) * 2 + (x >> 1)]);
+			NodeId cells[4] = { q.nw, q.ne, q.sw, q.se };
+			if (cells[(y & 1) * 2 + (x & 1)] == LIVE_CELL)
+				bits |= 1 << (y * 4 + x);
+		}
+	}
+
+	// Apply the rules to the four centre cells
+	for (y = 1; y < 3; y++) {
+		for (x = 1; x < 3; x++) {
+			unsigned int count = 0, dx, dy;
+			for (dy = y - 1; dy <= y + 1; dy++)
+				for (dx = x - 1; dx <= x + 1; dx++)
+					count += (bits >> (dy * 4 + dx)) & 1;
+			unsigned int alive = (bits >> (y * 4 + x)) & 1;
+			count -= alive;
+
+			// On cell stays on with 2 or 3 neighbours, off cell turns on with 3
+			bool on = (count == 3) || (alive && count == 2);
+			next[(y - 1) * 2 + (x - 1)] = on ? LIVE_CELL : DEAD_CELL;
+		}
+	}
+
+	return Find(next[0], next[1], next[2], next[3]);
+}
+
+// Advances (or just centres, if advance is false) the nine level n-1
+// squares of a level n node, in parallel for large nodes
+void HashLife::SubResults(NodeId n, unsigned int k, bool advance, NodeId sub[9], NodeId r[9])
+{
+	if (pool && advance && At(n).level >= HASHLIFE_PARALLEL_LEVEL) {
+		TaskGroup group;
+		for (int i = 0; i < 9; i++)
+			pool->Submit(group, [this, sub, r, k, i] { r[i] = Result(sub[i], k); });
+		pool->Wait(group);
+		return;
+	}
+
+	for (int i = 0; i < 9; i++)
+		r[i] = advance ? Result(sub[i], k) : Centre(sub[i]);
+}
+
+// Centre of a level n node advanced 2^min(k, n-2) generations, or
+// NO_NODE if the jump ran out of budget
+HashLife::NodeId HashLife::Result(NodeId id, unsigned int k)
+{
+	if (over_budget.load(memory_order_relaxed))
+		return NO_NODE;
+
+	Node& n = At(id);
+	int level = n.level;
+	int step = ((int)k < level - 2) ? (int)k : level - 2;
+
+	// result is stored before result_step, so a matching step means the result is complete
+	if (n.result_step.load(memory_order_acquire) == step) {
+		cache_hits.fetch_add(1, memory_order_relaxed);
+		return n.result.load(memory_order_relaxed);
+	}
+	cache_misses.fetch_add(1, memory_order_relaxed);
+
+	NodeId result;
+	if (n.population == 0)
+		result = EmptyNode(level - 1);
+	else if (level == 2)
+		result = BaseResult(id);
+	else {
+
+		// Nine overlapping level n-1 squares covering the node
+		NodeId sub[9] = {
+			n.nw, HorizontalCentre(n.nw, n.ne), n.ne,
+			VerticalCentre(n.nw, n.sw), Centre(id), VerticalCentre(n.ne, n.se),
+			n.sw, HorizontalCentre(n.sw, n.se), n.se
+		};
+
+		// First half of the jump, skipped (centre only) when stepping slower than full speed
+		NodeId r[9];
+		SubResults(id, k, step == level - 2, sub, r);
+		if (over_budget.load(memory_order_relaxed))
+			return NO_NODE;
+
+		// Second half of the jump on the four overlapping quadrants
+		NodeId quad[4] = {
+			Find(r[0], r[1], r[3], r[4]),
+			Find(r[1], r[2], r[4], r[5]),
+			Find(r[3], r[4], r[6], r[7]),
+			Find(r[4], r[5], r[7], r[8])
+		};
+		NodeId q[4];
+		if (pool && level >= HASHLIFE_PARALLEL_LEVEL) {
+			TaskGroup group;
+			for (int i = 0; i < 4; i++)
+				pool->Submit(group, [this, &quad, &q, k, i] { q[i] = Result(quad[i], k); });
+			pool->Wait(group);
+		}
+		else {
+			for (int i = 0; i < 4; i++)
+				q[i] = Result(quad[i], k);
+		}
+		if (over_budget.load(memory_order_relaxed))
+			return NO_NODE;
+		result = Find(q[0], q[1], q[2], q[3]);
+	}
+
+	// Slabs never move, so n is still valid after the nodes created above
+	n.result.store(result, memory_order_relaxed);
+	n.result_step.store(step, memory_order_release);
+	return result;
+}
+
+// Returns n with the cell at (x, y), relative to its top left, replaced
+HashLife::NodeId HashLife::Set(NodeId id, int64_t x, int64_t y, NodeId cell)
+{
+	Node& n = At(id);
+	if (n.level == 0)
+		return cell;
+
+	int64_t half = (int64_t)1 << (n.level - 1);
+	if (y < half) {
+		if (x < half)
+			return Find(Set(n.nw, x, y, cell), n.ne, n.sw, n.se);
+		return Find(n.nw, Set(n.ne, x - half, y, cell), n.sw, n.se);
+	}
+	if (x < half)
+		return Find(n.nw, n.ne, Set(n.sw, x, y - half, cell), n.se);
+	return Find(n.nw, n.ne, n.sw, Set(n.se, x - half, y - half, cell));
+}
+
+// Doubles the root's size, keeping its contents at the centre
+void HashLife::Expand()
+{
+	Node& r = At(root);
+	NodeId e = EmptyNode(r.level - 1);
+	root = Find(
+		Find(e, e, e, r.nw),
+		Find(e, e, r.ne, e),
+		Find(e, r.sw, e, e),
+		Find(r.se, e, e, e));
+}
+
+bool HashLife::Contains(int64_t x, int64_t y) const
+{
+	int64_t half = (int64_t)1 << (At(root).level - 1);
+	return x >= -half && x < half && y >= -half && y < half;
+}
+
+// False if (x, y) is beyond the reach of the largest root
+bool HashLife::ExpandToContain(int64_t x, int64_t y)
+{
+	while (!Contains(x, y) && At(root).level < HASHLIFE_MAX_LEVEL)
+		Expand();
+	return Contains(x, y);
+}
+
+// True if every live cell is within the centre quarter of the root
+bool HashLife::BorderEmpty() const
+{
+	Node& r = At(root);
+	return (At(r.nw).population == At(At(At(r.nw).se).se).population)
+		&& (At(r.ne).population == At(At(At(r.ne).sw).sw).population)
+		&& (At(r.sw).population == At(At(At(r.sw).ne).ne).population)
+		&& (At(r.se).population == At(At(At(r.se).nw).nw).population);
+}
+
+// False (and nothing set) if (x, y) is beyond the reach of the largest root
+bool HashLife::SetCell(int64_t x, int64_t y)
+{
+	if (!ExpandToContain(x, y))
+		return false;
+	int64_t half = (int64_t)1 << (At(root).level - 1);
+	root = Set(root, x + half, y + half, LIVE_CELL);
+	return true;
+}
+
+void HashLife::ClearCell(int64_t x, int64_t y)
+{
+	if (!Contains(x, y))
+		return;
+	int64_t half = (int64_t)1 << (At(root).level - 1);
+	root = Set(root, x + half, y + half, DEAD_CELL);
+}
+
+int HashLife::CellState(int64_t x, int64_t y)
+{
+	if (!Contains(x, y))
+		return 0;
+
+	NodeId id = root;
+	int64_t half = (int64_t)1 << (At(id).level - 1);
+	x += half;
+	y += half;
+	while (At(id).level > 0 && At(id).population) {
+		Node& n = At(id);
+		half = (int64_t)1 << (n.level - 1);
+		if (y < half)
+			id = (x < half) ? n.nw : n.ne;
+		else
+			id = (x < half) ? n.sw : n.se;
+		x &= half - 1;
+		y &= half - 1;
+	}
+	return At(id).population ? 1 : 0;
+}
+
+uint64_t HashLife::Population() const
+{
+	return At(root).population;
+}
+
+// False if the pattern would go beyond the reach of the largest root
+// before all 2^k generations are done; Generation() tells how far it got
+bool HashLife::Step(unsigned int k)
+{
+	if (node_count > budget_nodes)
+		CollectGarbage();
+
+	// The result is the root's centre half. The pattern can grow by at
+	// most 2^k cells in each direction, so it must sit in the centre
+	// quarter of a root at least 2^(k+3) wide for the result to hold all
+	// of it
+	while ((At(root).level < (int)k + 3 || !BorderEmpty()) && At(root).level < HASHLIFE_MAX_LEVEL)
+		Expand();
+	if (At(root).level < (int)k + 3 || !BorderEmpty())
+		return false;
+
+	// A jump that runs out of budget is abandoned, and once its nodes are
+	// collected it is taken as two half-size jumps. A single generation
+	// can't be split, so it may go over
+	over_budget = false;
+	enforce_budget = (k > 0);
+	NodeId result = Result(root, k);
+	enforce_budget = false;
+	if (result == NO_NODE) {
+		CollectGarbage();
+		return Step(k - 1) && Step(k - 1);
+	}
+
+	root = result;
+	generation += (uint64_t)1 << k;
+	return true;
+}
+
+void HashLife::SetMemoryBudget(size_t bytes)
+{
+	budget_nodes = bytes / sizeof(Node);
+}
+
+// Marks n and everything reachable from it
+void HashLife::Mark(NodeId id, bool keep_results)
+{
+	Node& n = At(id);
+	if (n.marked || n.level == 0)
+		return;
+	n.marked = true;
+
+	Mark(n.nw, keep_results);
+	Mark(n.ne, keep_results);
+	Mark(n.sw, keep_results);
+	Mark(n.se, keep_results);
+
+	NodeId result = n.result.load(memory_order_relaxed);
+	if (keep_results && result != NO_NODE)
+		Mark(result, keep_results);
+}
+
+// Frees every unmarked node and clears the marks of the rest
+void HashLife::Sweep(bool keep_results)
+{
+	for (int i = 0; i < HASH_SEGMENTS; i++) {
+		Segment& segment = segments[i];
+		for (size_t j = 0; j < segment.buckets.size(); j++) {
+			NodeId* link = &segment.buckets[j];
+			while (*link != NO_NODE) {
+				NodeId id = *link;
+				Node& n = At(id);
+				if (n.marked) {
+					n.marked = false;
+					if (!keep_results) {
+						n.result.store(NO_NODE, memory_order_relaxed);
+						n.result_step.store(-1, memory_order_relaxed);
+					}
+					link = &n.next;
+				}
+				else {
+					*link = n.next;
+					free_nodes.push_back(id);
+					segment.count--;
+					node_count--;
+					nodes_freed++;
+				}
+			}
+		}
+	}
+}
+
+// Frees nodes unreachable from the root, dropping the memo if that is not enough
+void HashLife::CollectGarbage()
+{
+	bool keep_results = true;
+	for (;;) {
+		collections++;
+		for (int level = 0; level <= HASHLIFE_MAX_LEVEL + 1; level++)
+			Mark(empty_nodes[level], keep_results);
+		Mark(root, keep_results);
+		Sweep(keep_results);
+
+		if (!keep_results || node_count <= budget_nodes / 2)
+			break;
+		keep_results = false;
+	}
+}
+
+HashLifeStats HashLife::Stats() const
+{
+	HashLifeStats stats;
+	stats.nodes_live = node_count;
+	stats.nodes_freed = nodes_freed;
+	stats.cache_hits = cache_hits;
+	stats.cache_misses = cache_misses;
+	stats.collections = collections;
+	stats.bytes_reserved = (size_t)slab_count * SLAB_SIZE * sizeof(Node);
+	return stats;
+}
+
+// Level n node whose top left is universe (ox, oy), copied from the map
+// placed with its top left at universe (x0, y0)
+HashLife::NodeId HashLife::Build(LifeEngine& map, int64_t x0, int64_t y0, int level, int64_t ox, int64_t oy)
+{
+	int64_t size = (int64_t)1 << level;
+
+	// Squares outside the map are empty
+	if (ox + size <= x0 || ox >= x0 + map.Width() || oy + size <= y0 || oy >= y0 + map.Height())
+		return EmptyNode(level);
+
+	if (level == 0)
+		return map.CellState((int)(ox - x0), (int)(oy - y0)) ? LIVE_CELL : DEAD_CELL;
+
+	int64_t half = size / 2;
+	return Find(
+		Build(map, x0, y0, level - 1, ox, oy),
+		Build(map, x0, y0, level - 1, ox + half, oy),
+		Build(map, x0, y0, level - 1, ox, oy + half),
+		Build(map, x0, y0, level - 1, ox + half, oy + half));
+}
+
+// Replaces the universe with the cells of the map placed at (x0, y0).
+// False (and the universe unchanged) if the map is beyond the reach of
+// the largest root
+bool HashLife::Import(LifeEngine& map, int64_t x0, int64_t y0)
+{
+	NodeId old_root = root;
+	root = EmptyNode(3);
+	if (!ExpandToContain(x0, y0) || !ExpandToContain(x0 + map.Width() - 1, y0 + map.Height() - 1)) {
+		root = old_root;
+		return false;
+	}
+
+	int level = At(root).level;
+	int64_t half = (int64_t)1 << (level - 1);
+	root = Build(map, x0, y0, level, -half, -half);
+	return true;
+}
+
+// Updates (and draws) the cells of the map that differ from the level n
+// node whose top left is universe (ox, oy)
+void HashLife::Paint(NodeId id, LifeEngine& map, int64_t x0, int64_t y0, int64_t ox, int64_t oy)
+{
+	Node& n = At(id);
+	int64_t size = (int64_t)1 << n.level;
+	int64_t left = (ox > x0) ? ox : x0;
+	int64_t top = (oy > y0) ? oy : y0;
+	int64_t right = (ox + size < x0 + map.Width()) ? ox + size : x0 + map.Width();
+	int64_t bottom = (oy + size < y0 + map.Height()) ? oy + size : y0 + map.Height();
+
+	if (left >= right || top >= bottom)
+		return;
+
+	if (n.population == 0) {
+		for (int64_t y = top; y < bottom; y++) {
+			for (int64_t x = left; x < right; x++) {
+				unsigned int mx = (unsigned int)(x - x0), my = (unsigned int)(y - y0);
+				if (map.CellState(mx, my)) {
+					map.ClearCell(mx, my);
+					DrawCell(mx, my, OFF_COLOUR);
+				}
+			}
+		}
+		return;
+	}
+
+	if (n.level == 0) {
+		unsigned int mx = (unsigned int)(ox - x0), my = (unsigned int)(oy - y0);
+		if (!map.CellState(mx, my)) {
+			map.SetCell(mx, my);
+			DrawCell(mx, my, ON_COLOUR);
+		}
+		return;
+	}
+
+	int64_t half = size / 2;
+	Paint(n.nw, map, x0, y0, ox, oy);
+	Paint(n.ne, map, x0, y0, ox + half, oy);
+	Paint(n.sw, map, x0, y0, ox, oy + half);
+	Paint(n.se, map, x0, y0, ox + half, oy + half);
+}
+
+// Copies the universe into the map placed at (x0, y0), drawing changed
+// cells. False (and the map unchanged) if the map is beyond the reach of
+// the largest root
+bool HashLife::Export(LifeEngine& map, int64_t x0, int64_t y0)
+{
+	if (!ExpandToContain(x0, y0) || !ExpandToContain(x0 + map.Width() - 1, y0 + map.Height() - 1))
+		return false;
+
+	int64_t half = (int64_t)1 << (At(root).level - 1);
+	Paint(root, map, x0, y0, -half, -half);
+	return true;
+}
+
+HashLifeMap::HashLifeMap(unsigned int w, unsigned int h, unsigned int step_log2, unsigned int threads, size_t budget_bytes)
+	: LifeEngine(w, h), universe(threads), view(w, h)
+{
+	this->step_log2 = step_log2;
+	view_changed = false;
+	stalled = false;
+	last_advanced = 0;
+	universe.SetMemoryBudget(budget_bytes);
+}
+
+void HashLifeMap::SetCell(unsigned int x, unsigned int y)
+{
+	view.SetCell(x, y);
+	view_changed = true;
+}
+
+void HashLifeMap::ClearCell(unsigned int x, unsigned int y)
+{
+	view.ClearCell(x, y);
+	view_changed = true;
+}
+
+int HashLifeMap::CellState(int x, int y)
+{
+	return view.CellState(x, y);
+}
+
+void HashLifeMap::NextGen()
+{
+	// Cells edited on screen replace the universe
+	if (view_changed) {
+		universe.Import(view, 0, 0);
+		view_changed = false;
+	}
+
+	// Once the pattern has outgrown the universe the view stays as it is
+	last_advanced = 0;
+	if (stalled)
+		return;
+	uint64_t start = universe.Generation();
+	if (!universe.Step(step_log2)) {
+		stalled = true;
+		cout << "HashLife can't advance 2^" << step_log2 << " generations: the pattern has outgrown 64-bit coordinates" << endl;
+	}
+	last_advanced = universe.Generation() - start;
+	universe.Export(view, 0, 0);
+}
+
+void HashLifeMap::PrintStats()
+{
+	HashLifeStats stats = universe.Stats();
+	uint64_t lookups = stats.cache_hits + stats.cache_misses;
+
+	cout << "HashLife generation: " << universe.Generation()
+		<< (stalled ? " (stalled)" : "")
+		<< "\nPopulation: " << universe.Population()
+		<< "\nNodes live: " << stats.nodes_live
+		<< "\nNodes freed: " << stats.nodes_freed
+		<< "\nGarbage collections: " << stats.collections
+		<< "\nArena size (MB): " << (stats.bytes_reserved >> 20)
+		<< "\nCache hit rate: " << (lookups ? 100.0 * stats.cache_hits / lookups : 0.0) << "%" << endl;
+}
@@ -0,0 +1,178 @@
+// BASED ON BILL GOSPER'S HASHLIFE ALGORITHM
+#pragma once
+
+#include "LifeEngine.h"
+#include "CellMap.h"
+#include "ThreadPool.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// Number of independently locked segments in the node hash table
+#define HASH_SEGMENTS 64
+// Smallest node level whose sub-results are computed as parallel tasks
+#define HASHLIFE_PARALLEL_LEVEL 9
+// Deepest level a root can reach (coordinates are 64-bit)
+#define HASHLIFE_MAX_LEVEL 62
+// Largest jump, as a power of 2, the deepest root can take (a jump of 2^k needs a root of level k + 3)
+#define HASHLIFE_MAX_STEP (HASHLIFE_MAX_LEVEL - 3)
+// Nodes per arena slab, as a power of 2
+#define HASHLIFE_SLAB_BITS 16
+// Default memory budget for nodes in megabytes
+#define HASHLIFE_DEFAULT_BUDGET_MB 512
+// Largest memory budget in megabytes: well under the 2^32 nodes a 32-bit
+// index can reach, or the 2 GB a 32-bit build can address
+#define HASHLIFE_MAX_BUDGET_MB (sizeof(void*) > 4 ? 65536 : 2048)
+
+// HASHLIFE STRUCTURE
+/*
+The universe is an unbounded plane stored as a quadtree. A node of level
+n is a 2^n x 2^n square made of four level n-1 quadrants; level 0 nodes
+are single cells. Nodes are canonicalised through a hash table keyed on
+their quadrants, so identical squares anywhere in space or time are
+stored once. Each node memoises its result: the centre 2^(n-1) square
+advanced 2^k generations (k <= n-2), which is what makes repetitive
+patterns cheap to run for millions of generations.
+
+Universe coordinates are signed; the root of level L covers
+[-2^(L-1), 2^(L-1)) in both axes. Roots stop growing at
+HASHLIFE_MAX_LEVEL, so cells can only be set in [-2^61, 2^61), and a
+jump fails (leaving the universe as it was) if its result would not fit.
+
+With more than one thread the nine sub-results and the four final
+quadrants of large nodes are computed as tasks on a thread pool. The
+hash table is split into segments, each with its own lock and its own
+buckets, so threads creating nodes rarely contend. Results are
+published with release/acquire ordering; two threads racing on the
+same node compute the same canonical result, so either write wins.
+
+Nodes live in an arena of fixed-size slabs and refer to each other by
+32-bit index rather than by pointer. Before each Step, if the nodes in
+use exceed the memory budget, a mark-and-sweep pass frees every node
+unreachable from the root (keeping memoised results); if that is not
+enough the memo is dropped too. Freed nodes go on a free list and are
+reused before new slabs are allocated. The budget is also checked as
+nodes are created during a jump: once it is reached, Result unwinds
+without memoising anything further, the garbage is collected and the
+jump is redone as two half-size jumps. Only a single generation, which
+can't be split, may go over the budget.
+*/
+
+// Counters reported by HashLife::Stats()
+struct HashLifeStats
+{
+	size_t nodes_live;
+	uint64_t nodes_freed;
+	uint64_t cache_hits;
+	uint64_t cache_misses;
+	unsigned int collections;
+	size_t bytes_reserved;
+};
+
+// HashLife stores an unbounded universe as a canonical quadtree
+class HashLife
+{
+public:
+	HashLife(unsigned int threads = 1);
+	~HashLife();
+	bool SetCell(int64_t x, int64_t y); // False if out of reach
+	void ClearCell(int64_t x, int64_t y);
+	int CellState(int64_t x, int64_t y);
+	bool Step(unsigned int k); // Advance 2^k generations; false if the pattern goes out of reach
+	bool Import(LifeEngine& map, int64_t x0, int64_t y0);
+	bool Export(LifeEngine& map, int64_t x0, int64_t y0);
+	uint64_t Population() const;
+	uint64_t Generation() const { return generation; }
+	size_t NodeCount() const { return node_count; }
+	void SetMemoryBudget(size_t bytes);
+	void CollectGarbage();
+	HashLifeStats Stats() const;
+private:
+	typedef uint32_t NodeId;
+
+	struct Node
+	{
+		NodeId nw, ne, sw, se; // Quadrants (unused for cells)
+		std::atomic<NodeId> result; // Memoised centre after 2^result_step generations
+		std::atomic<int> result_step;
+		NodeId next; // Hash chain
+		unsigned char level;
+		bool marked; // Reachable, during garbage collection
+		uint64_t population;
+	};
+
+	struct Segment
+	{
+		std::mutex lock;
+		std::vector<NodeId> buckets;
+		size_t count;
+	};
+
+	Node& At(NodeId id) const { return slabs[id >> HASHLIFE_SLAB_BITS][id & ((1 << HASHLIFE_SLAB_BITS) - 1)]; }
+	NodeId Allocate();
+	NodeId Find(NodeId nw, NodeId ne, NodeId sw, NodeId se);
+	NodeId EmptyNode(int level);
+	NodeId Centre(NodeId n);
+	NodeId HorizontalCentre(NodeId w, NodeId e);
+	NodeId VerticalCentre(NodeId n, NodeId s);
+	NodeId Result(NodeId n, unsigned int k);
+	NodeId BaseResult(NodeId n);
+	void SubResults(NodeId n, unsigned int k, bool advance, NodeId sub[9], NodeId r[9]);
+	NodeId Set(NodeId n, int64_t x, int64_t y, NodeId cell);
+	NodeId Build(LifeEngine& map, int64_t x0, int64_t y0, int level, int64_t ox, int64_t oy);
+	void Paint(NodeId n, LifeEngine& map, int64_t x0, int64_t y0, int64_t ox, int64_t oy);
+	void Expand();
+	bool ExpandToContain(int64_t x, int64_t y);
+	bool Contains(int64_t x, int64_t y) const;
+	bool BorderEmpty() const;
+	void Rehash(Segment& segment);
+	void Mark(NodeId n, bool keep_results);
+	void Sweep(bool keep_results);
+
+	Node** slabs; // Arena; slab i holds nodes [i << HASHLIFE_SLAB_BITS, (i + 1) << HASHLIFE_SLAB_BITS)
+	unsigned int slab_count;
+	NodeId next_free; // First never-used node index
+	std::vector<NodeId> free_nodes; // Nodes released by garbage collection
+	std::mutex alloc_lock;
+
+	NodeId root;
+	Segment segments[HASH_SEGMENTS];
+	NodeId empty_nodes[HASHLIFE_MAX_LEVEL + 2]; // Canonical empty node of each level
+	std::atomic<size_t> node_count;
+	uint64_t generation;
+	ThreadPool* pool; // NULL when single threaded
+
+	size_t budget_nodes;
+	bool enforce_budget; // Set while a jump that can still be split is running
+	std::atomic<bool> over_budget; // The running jump has reached the budget
+	uint64_t nodes_freed;
+	unsigned int collections;
+	std::atomic<uint64_t> cache_hits;
+	std::atomic<uint64_t> cache_misses;
+};
+
+// HashLifeMap shows the region [0, w) x [0, h) of a HashLife universe.
+// Unlike the other engines the plane does not wrap around; cells that
+// leave the window keep evolving off screen. Each NextGen advances
+// 2^step_log2 generations.
+class HashLifeMap final : public LifeEngine
+{
+public:
+	HashLifeMap(unsigned int w, unsigned int h, unsigned int step_log2, unsigned int threads, size_t budget_bytes);
+	void SetCell(unsigned int x, unsigned int y);
+	void ClearCell(unsigned int x, unsigned int y);
+	int CellState(int x, int y);
+	void NextGen();
+	void PrintStats();
+	uint64_t GenerationsAdvanced() const { return last_advanced; }
+private:
+	HashLife universe;
+	CellMap view; // Cells currently on screen
+	unsigned int step_log2;
+	bool view_changed; // Cells set directly since the last NextGen
+	bool stalled; // A step failed because the pattern outgrew the universe
+	uint64_t last_advanced; // Generations the last NextGen advanced
+};
@@ -0,0 +1,149 @@
+#include "IsotropicMap.h"
+#include "BitOps.h"
+#include "Common.h"
+
+#include <cstring>
+
+IsotropicMap::IsotropicMap(unsigned int w, unsigned int h) : LifeEngine(w, h)
+{
+	words_per_row = (w + 63) / 64;
+	last_bit = (w - 1) % 64;
+	tail_mask = (last_bit == 63) ? ~0ULL : ((1ULL << (last_bit + 1)) - 1);
+	rows = new uint64_t[words_per_row * h];  // cell storage
+	next_rows = new uint64_t[words_per_row * h]; // next generation storage
+	memset(rows, 0, words_per_row * h * sizeof(uint64_t));  // clear all cells, to start
+	SetRule(LifeRule());
+}
+
+IsotropicMap::~IsotropicMap()
+{
+	delete[] rows;
+	delete[] next_rows;
+}
+
+void IsotropicMap::SetCell(unsigned int x, unsigned int y)
+{
+	rows[y * words_per_row + x / 64] |= 1ULL << (x % 64);
+}
+
+// The bitmap has the same layout as the map
+void IsotropicMap::LoadStateBitmap(const uint64_t* bitmap, unsigned int words_per_row)
+{
+	memcpy(rows, bitmap, (size_t)words_per_row * height * sizeof(uint64_t));
+}
+
+void IsotropicMap::ClearCell(unsigned int x, unsigned int y)
+{
+	rows[y * words_per_row + x / 64] &= ~(1ULL << (x % 64));
+}
+
+int IsotropicMap::CellState(int x, int y)
+{
+	return (rows[y * words_per_row + x / 64] >> (x % 64)) & 1;
+}
+
+bool IsotropicMap::SetRule(const LifeRule& rule)
+{
+	if (rule.states != 2)
+		return false;
+	return SetIsotropicRule(IsotropicRule(rule));
+}
+
+// Builds the table of next states for pairs of cells from the rule's
+// table for single cells
+bool IsotropicMap::SetIsotropicRule(const IsotropicRule& rule)
+{
+	for (unsigned int i = 0; i < PAIR_TABLE_SIZE; i++) {
+		pair_next[i] = 0;
+		for (unsigned int cell = 0; cell < 2; cell++) {
+			unsigned int index = 0;
+			for (unsigned int dx = 0; dx < 3; dx++)
+				for (unsigned int dy = 0; dy < 3; dy++)
+					if (i & (1 << (dy * 4 + cell + dx)))
+						index |= 1 << (dx * 3 + dy);
+			pair_next[i] |= rule.next[index] << cell;
+		}
+	}
+	return true;
+}
+
+// Word whose bit b holds the state of the cell to the left of cell b,
+// wrapping the first cell of the row around to the last
+inline uint64_t IsotropicMap::West(const uint64_t* row, unsigned int i) const
+{
+	uint64_t carry = (i == 0) ? row[words_per_row - 1] >> last_bit : row[i - 1] >> 63;
+	return (row[i] << 1) | carry;
+}
+
+// Word whose bit b holds the state of the cell to the right of cell b,
+// wrapping the last cell of the row around to the first
+inline uint64_t IsotropicMap::East(const uint64_t* row, unsigned int i) const
+{
+	if (i + 1 < words_per_row)
+		return (row[i] >> 1) | (row[i + 1] << 63);
+	return (row[i] >> 1) | ((row[0] & 1) << last_bit);
+}
+
+void IsotropicMap::NextGen()
+{
+	unsigned int x, y, i, bit;
+	unsigned int h = height, n = words_per_row;
+	const uint64_t *above, *row, *below;
+	uint64_t *next_row, *swap;
+
+	for (y = 0; y < h; y++) {
+
+		row = rows + y * n;
+		above = (y == 0) ? rows + (h - 1) * n : row - n;
+		below = (y == (h - 1)) ? rows : row + n;
+		next_row = next_rows + y * n;
+
+		for (i = 0; i < n; i++) {
+
+			uint64_t w_above = West(above, i), e_above = East(above, i);
+			uint64_t w_row = West(row, i), e_row = East(row, i);
+			uint64_t w_below = West(below, i), e_below = East(below, i);
+			unsigned int bits = (i + 1 < n) ? 64 : last_bit + 1;
+			uint64_t next = 0;
+
+			// Cells with no live cell around them stay dead (there is no B0)
+			uint64_t occupied = w_above | above[i] | e_above | w_row | row[i] | e_row | w_below | below[i] | e_below;
+			if (occupied == 0) {
+				next_row[i] = 0;
+				continue;
+			}
+
+			// Bits b to b + 3 of the West words hold the four columns around
+			// cells b and b + 1, until the last pair in the word
+			for (bit = LowestBit(occupied) & ~1; bit + 2 < bits && (occupied >> bit) != 0; bit += 2) {
+				unsigned int index = (unsigned int)(((w_above >> bit) & 0xF) | (((w_row >> bit) & 0xF) << 4) | (((w_below >> bit) & 0xF) << 8));
+				next |= (uint64_t)pair_next[index] << bit;
+			}
+
+			// The last pair takes its right-hand columns from the East
+			// words, which wrap around at the end of the row
+			if (bit < bits && (occupied >> bit) != 0) {
+				unsigned int index = (unsigned int)(((w_above >> bit) & 0x3) | (((e_above >> bit) & 0x3) << 2)
+					| (((w_row >> bit) & 0x3) << 4) | (((e_row >> bit) & 0x3) << 6)
+					| (((w_below >> bit) & 0x3) << 8) | (((e_below >> bit) & 0x3) << 10));
+				next |= (uint64_t)pair_next[index] << bit;
+			}
+			next_row[i] = next;
+		}
+		next_row[n - 1] &= tail_mask;
+		// Draw the cells that changed
+		for (i = 0; i < n; i++) {
+			uint64_t changed = next_row[i] ^ row[i];
+			while (changed) {
+				bit = LowestBit(changed);
+				x = i * 64 + bit;
+				DrawCell(x, y, ((next_row[i] >> bit) & 1) ? ON_COLOUR : OFF_COLOUR);
+				changed &= changed - 1;
+			}
+		}
+	}
+
+	swap = rows;
+	rows = next_rows;
+	next_rows = swap;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "LifeEngine.h"
+#include "IsotropicRule.h"
+
+#include <cstdint>
+
+// Entries in the table of next states for a pair of cells
+#define PAIR_TABLE_SIZE 4096
+
+// ISOTROPIC STRUCTURE
+/*
+Cells are stored one bit per cell in 64-bit words exactly as in
+BitPackedMap. Non-totalistic rules depend on where the neighbours are,
+not just how many there are, so each cell's next state is looked up in
+the rule's 512-entry table indexed by its whole 3x3 neighbourhood.
+
+NextGen looks up two cells at a time: the four columns around a pair
+of cells in the rows above, at and below them make a 12-bit index into
+a table of both next states, built from the rule's table by SetRule.
+Each row supplies its four bits with one shift and mask of the word of
+western neighbours. Words whose cells, and the cells beside them, are
+all dead stay dead without being scanned, and a word is only scanned as
+far as its last live column.
+*/
+
+// IsotropicMap runs isotropic non-totalistic rules on a bit-packed map
+class IsotropicMap final : public LifeEngine
+{
+public:
+	IsotropicMap(unsigned int w, unsigned int h);
+	~IsotropicMap();
+	void SetCell(unsigned int x, unsigned int y);
+	void ClearCell(unsigned int x, unsigned int y);
+	int CellState(int x, int y);
+	void LoadStateBitmap(const uint64_t* bitmap, unsigned int words_per_row);
+	void NextGen();
+	bool SetRule(const LifeRule& rule);
+	bool SetIsotropicRule(const IsotropicRule& rule);
+private:
+	uint64_t West(const uint64_t* row, unsigned int i) const;
+	uint64_t East(const uint64_t* row, unsigned int i) const;
+
+	unsigned char pair_next[PAIR_TABLE_SIZE]; // Next states of cells b and b + 1 in bits 0 and 1,
+	// indexed by cells b - 1 to b + 2 above (bits 0-3), beside (bits 4-7) and below (bits 8-11)
+	uint64_t* rows;
+	uint64_t* next_rows;
+	unsigned int words_per_row;
+	unsigned int last_bit; // Bit index of cell (width - 1) in the last word of a row
+	uint64_t tail_mask; // Valid bits of the last word of a row
+};
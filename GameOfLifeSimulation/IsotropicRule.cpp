@@ -0,0 +1,141 @@
+#include "IsotropicRule.h"
+
+#include <cctype>
+#include <cstring>
+
+// Neighbours clockwise from north; bit n of a ring is neighbour n
+static const int ring_dx[8] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+static const int ring_dy[8] = { -1, -1, 0, 1, 1, 1, 0, -1 };
+
+// Hensel letters, and how many of them each count of neighbours uses
+static const char letters[] = "cekainyqjrtwz";
+static const unsigned int letter_count[9] = { 0, 2, 6, 10, 13, 10, 6, 2, 0 };
+
+// One ring of each letter for 1 to 4 neighbours. The neighbourhoods of
+// 5 to 7 neighbours are the complements of those of 3 to 1
+static const unsigned char hensel[5][13] = {
+	{ 0 },
+	{ 0x02, 0x01 },
+	{ 0x0A, 0x05, 0x09, 0x03, 0x11, 0x22 },
+	{ 0x2A, 0x15, 0x25, 0xC1, 0x83, 0x0D, 0x29, 0x89, 0x0B, 0x13 },
+	{ 0xAA, 0x55, 0xA5, 0xE1, 0x1B, 0x95, 0xA9, 0xC9, 0x8B, 0x17, 0x93, 0x8D, 0x33 }
+};
+
+// Smallest of the four rotations and four reflections of a ring
+static unsigned int Canonical(unsigned int ring)
+{
+	unsigned int mirror = 0, best = 0xFF;
+
+	for (unsigned int n = 0; n < 8; n++)
+		if (ring & (1 << n))
+			mirror |= 1 << ((8 - n) % 8);
+
+	for (unsigned int turn = 0; turn < 8; turn += 2) {
+		unsigned int a = ((ring << turn) | (ring >> (8 - turn))) & 0xFF;
+		unsigned int b = ((mirror << turn) | (mirror >> (8 - turn))) & 0xFF;
+		if (a < best)
+			best = a;
+		if (b < best)
+			best = b;
+	}
+	return best;
+}
+
+// Index into letters of the neighbourhood a ring of count neighbours forms
+static unsigned int Letter(unsigned int ring, unsigned int count)
+{
+	if (count > 4) {
+		ring ^= 0xFF;
+		count = 8 - count;
+	}
+	unsigned int shape = Canonical(ring);
+	for (unsigned int l = 0; l < letter_count[count]; l++)
+		if (Canonical(hensel[count][l]) == shape)
+			return l;
+	return 0; // 0 and 8 neighbours have a single neighbourhood
+}
+
+IsotropicRule::IsotropicRule() : IsotropicRule(LifeRule())
+{
+}
+
+// Expands a Life-like rule to every neighbourhood (Generations states are ignored)
+IsotropicRule::IsotropicRule(const LifeRule& rule)
+{
+	for (unsigned int i = 0; i < NEIGHBOURHOOD_SIZE; i++) {
+		unsigned int count = 0;
+		for (unsigned int bit = 0; bit < 9; bit++)
+			if ((i & ~NEIGHBOURHOOD_CENTRE) & (1 << bit))
+				count++;
+		next[i] = rule.next[(count << 1) | ((i & NEIGHBOURHOOD_CENTRE) ? 1 : 0)];
+	}
+}
+
+// Parses a rulestring, leaving the rule unchanged if it is not valid
+bool IsotropicRule::Parse(const char* rulestring)
+{
+	LifeRule totalistic;
+	if (totalistic.Parse(rulestring)) {
+		if (totalistic.states != 2)
+			return false;
+		*this = IsotropicRule(totalistic);
+		return true;
+	}
+
+	// Hensel notation: B and S followed by their counts, in either order,
+	// optionally separated by a slash. A count followed by letters applies
+	// only to those neighbourhoods; followed by a minus, to all but those
+	bool applies[2][256] = {}; // Birth, survival for each ring
+	bool seen[2] = { false, false };
+	const char* p = rulestring;
+
+	if (toupper(*p) != 'B' && toupper(*p) != 'S')
+		return false;
+
+	while (*p) {
+		int part = (toupper(*p) == 'B') ? 0 : (toupper(*p) == 'S') ? 1 : -1;
+		if (part < 0 || seen[part])
+			return false;
+		seen[part] = true;
+
+		for (p++; *p >= '0' && *p <= '8';) {
+			unsigned int count = *p++ - '0';
+			bool except = (*p == '-');
+			if (except)
+				p++;
+
+			const char* listed = p;
+			for (; *p && strchr(letters, *p); p++)
+				if ((unsigned int)(strchr(letters, *p) - letters) >= letter_count[count])
+					return false;
+			size_t listed_count = p - listed;
+			if (except && listed_count == 0)
+				return false;
+
+			for (unsigned int ring = 0; ring < 256; ring++) {
+				unsigned int n = 0;
+				for (unsigned int bit = 0; bit < 8; bit++)
+					n += (ring >> bit) & 1;
+				if (n != count)
+					continue;
+				bool named = memchr(listed, letters[Letter(ring, count)], listed_count) != NULL;
+				if (listed_count == 0 || named != except)
+					applies[part][ring] = true;
+			}
+		}
+		if (*p == '/' && p[1] != '\0')
+			p++;
+	}
+
+	if (applies[0][0])
+		return false;
+
+	for (unsigned int i = 0; i < NEIGHBOURHOOD_SIZE; i++) {
+		unsigned int ring = 0;
+		for (unsigned int n = 0; n < 8; n++)
+			if (i & (1 << ((ring_dx[n] + 1) * 3 + ring_dy[n] + 1)))
+				ring |= 1 << n;
+		next[i] = applies[(i & NEIGHBOURHOOD_CENTRE) ? 1 : 0][ring];
+	}
+	return true;
+}
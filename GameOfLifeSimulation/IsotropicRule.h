@@ -0,0 +1,25 @@
+#pragma once
+
+#include "LifeRule.h"
+
+// Index into IsotropicRule::next for a 3x3 neighbourhood. Bit (dx + 1) * 3 + (dy + 1)
+// holds the cell at (x + dx, y + dy), so bits 0-2 are the column to the left
+// (top to bottom), bits 3-5 the cell's own column and bits 6-8 the column to the right
+#define NEIGHBOURHOOD_SIZE 512
+// Bit of a neighbourhood index holding the cell itself
+#define NEIGHBOURHOOD_CENTRE 0x10
+
+// IsotropicRule is an isotropic non-totalistic rule in Hensel notation,
+// e.g. "B2-a/S12". Each count may be followed by letters naming which of
+// its neighbourhoods (up to rotation and reflection) it applies to, or a
+// minus and the letters it does not apply to. Plain B/S rules, and the
+// other forms LifeRule accepts, are parsed too, except Generations rules.
+// Rules with B0 are rejected.
+struct IsotropicRule
+{
+	IsotropicRule(); // Conway's Life
+	IsotropicRule(const LifeRule& rule);
+	bool Parse(const char* rulestring);
+
+	unsigned char next[NEIGHBOURHOOD_SIZE]; // Next state for each neighbourhood index
+};
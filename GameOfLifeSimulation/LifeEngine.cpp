@@ -0,0 +1,207 @@
+#include "LifeEngine.h"
+#include "BitOps.h"
+#include "Common.h"
+#include "Philox.h"
+#include "ThreadPool.h"
+
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+LifeEngine::LifeEngine(unsigned int w, unsigned int h)
+{
+	width = w;
+	height = h;
+}
+
+LifeEngine::~LifeEngine()
+{
+}
+
+// One SetCell per cell; engines whose SetCell touches the neighbours
+// override this to apply a whole batch at once
+void LifeEngine::SetCells(const CellCoord* coords, size_t count)
+{
+	for (size_t i = 0; i < count; i++) {
+		if (CellState(coords[i].x, coords[i].y) == 0)
+			SetCell(coords[i].x, coords[i].y);
+	}
+}
+
+void LifeEngine::ClearCells(const CellCoord* coords, size_t count)
+{
+	for (size_t i = 0; i < count; i++) {
+		if (CellState(coords[i].x, coords[i].y) != 0)
+			ClearCell(coords[i].x, coords[i].y);
+	}
+}
+
+// Wraps a coordinate into [0, n)
+static unsigned int Wrap(long long v, unsigned int n)
+{
+	long long r = v % n;
+	return (unsigned int)((r < 0) ? r + n : r);
+}
+
+// Sets the live cells of pattern, rotated or reflected by transform, with
+// the top left of the result at (x, y). The pattern wraps around the
+// edges of the map; its dead cells leave the map unchanged
+void LifeEngine::Stamp(const Pattern& pattern, int x, int y, Transform transform)
+{
+	unsigned int pw = pattern.width, ph = pattern.height;
+	vector<CellCoord> coords;
+
+	for (unsigned int py = 0; py < ph; py++) {
+		const uint64_t* row = &pattern.bits[(size_t)py * pattern.words_per_row];
+		for (unsigned int i = 0; i < pattern.words_per_row; i++) {
+			uint64_t word = row[i];
+			while (word) {
+				unsigned int px = i * 64 + LowestBit(word);
+				unsigned int tx, ty;
+				switch (transform) {
+				case TRANSFORM_ROTATE_90: tx = ph - 1 - py; ty = px; break;
+				case TRANSFORM_ROTATE_180: tx = pw - 1 - px; ty = ph - 1 - py; break;
+				case TRANSFORM_ROTATE_270: tx = py; ty = pw - 1 - px; break;
+				case TRANSFORM_FLIP_X: tx = pw - 1 - px; ty = py; break;
+				case TRANSFORM_FLIP_Y: tx = px; ty = ph - 1 - py; break;
+				case TRANSFORM_FLIP_DIAGONAL: tx = py; ty = px; break;
+				case TRANSFORM_FLIP_ANTIDIAGONAL: tx = ph - 1 - py; ty = pw - 1 - px; break;
+				default: tx = px; ty = py; break;
+				}
+				CellCoord c = { Wrap((long long)x + tx, width), Wrap((long long)y + ty, height) };
+				coords.push_back(c);
+				word &= word - 1;
+			}
+		}
+	}
+	if (!coords.empty())
+		SetCells(&coords[0], coords.size());
+}
+
+// Sets the cells whose bits are set in bitmap, which must be the map's
+// size with cell x of row y in bit x % 64 of word y * words_per_row + x / 64
+// and padding bits 0
+void LifeEngine::LoadStateBitmap(const uint64_t* bitmap, unsigned int words_per_row)
+{
+	for (unsigned int y = 0; y < height; y++) {
+		const uint64_t* row = bitmap + (size_t)y * words_per_row;
+		for (unsigned int i = 0; i < words_per_row; i++) {
+			uint64_t word = row[i];
+			while (word) {
+				SetCell(i * 64 + LowestBit(word), y);
+				word &= word - 1;
+			}
+		}
+	}
+}
+
+// Writes the state of every cell to bitmap, laid out as for LoadStateBitmap, so
+// one engine's cells can be loaded into another
+void LifeEngine::SaveStateBitmap(uint64_t* bitmap, unsigned int words_per_row)
+{
+	memset(bitmap, 0, (size_t)words_per_row * height * sizeof(uint64_t));
+	for (unsigned int y = 0; y < height; y++) {
+		uint64_t* row = bitmap + (size_t)y * words_per_row;
+		for (unsigned int x = 0; x < width; x++) {
+			if (CellState(x, y))
+				row[x / 64] |= 1ULL << (x % 64);
+		}
+	}
+}
+
+// Fills a row of bitmap words with cells that are each on with
+// probability level / 2^INIT_DENSITY_BITS. A cell is on if its random
+// number is below level; the numbers are made one bit at a time, top
+// bit first, from a random word per bit for 64 cells at once, and a
+// cell is decided at the first bit where its number differs from
+// level. Words stop once all their cells are decided (usually after
+// seven or eight bits), or when the rest of level is zero, which
+// leaves any undecided cells off. Random word i for a bit comes from
+// Philox counter (i / 2, y, bit, 0) under key (seed, 1), so rows can be
+// filled on any thread in any order
+static void FillRow(uint64_t* row, unsigned int words, unsigned int y, unsigned int level, uint64_t tail_mask)
+{
+	uint32_t key[2] = { seed, 1 };
+	uint32_t ctr[4] = { 0, y, 0, 0 };
+	uint32_t out[4];
+	unsigned int i, bit;
+
+	if (level == 0 || level >= (1u << INIT_DENSITY_BITS)) {
+		memset(row, (level == 0) ? 0x00 : 0xFF, words * sizeof(uint64_t));
+		row[words - 1] &= tail_mask;
+		return;
+	}
+
+	unsigned int last_bit = LowestBit(level);
+	for (i = 0; i < words; i += 2) {
+		uint64_t on0 = 0, on1 = 0;
+		uint64_t undecided0 = ~0ULL, undecided1 = ~0ULL;
+		ctr[0] = i / 2;
+		for (bit = INIT_DENSITY_BITS - 1; ; bit--) {
+			ctr[2] = bit;
+			Philox4x32(ctr, key, out);
+			uint64_t r0 = out[0] | ((uint64_t)out[1] << 32);
+			uint64_t r1 = out[2] | ((uint64_t)out[3] << 32);
+			if ((level >> bit) & 1) {
+				on0 |= undecided0 & ~r0; // Random bit 0 under a 1: below level
+				on1 |= undecided1 & ~r1;
+				undecided0 &= r0;
+				undecided1 &= r1;
+			}
+			else {
+				undecided0 &= ~r0; // Random bit 1 over a 0: not below level
+				undecided1 &= ~r1;
+			}
+			if (bit == last_bit || (undecided0 | undecided1) == 0)
+				break;
+		}
+		row[i] = on0;
+		if (i + 1 < words)
+			row[i + 1] = on1;
+	}
+	row[words - 1] &= tail_mask;
+}
+
+// Shared by all engines so the same seed gives the same starting soup
+// whichever engine is selected. The soup is made one bitmap row at a
+// time on every core, then handed to the engine with LoadStateBitmap
+void LifeEngine::Init()
+{
+	unsigned int words_per_row = (width + 63) / 64;
+	uint64_t tail_mask = (width % 64) ? (1ULL << (width % 64)) - 1 : ~0ULL;
+	unsigned int level;
+
+	// Get seed; random if 0
+	if (seed == 0)
+		seed = (unsigned)time(NULL);
+
+	// Randomly initialise cell map with density of on cells
+	cout << "Initializing" << endl;
+
+	if (density <= 0.0)
+		level = 0;
+	else if (density >= 1.0)
+		level = 1u << INIT_DENSITY_BITS;
+	else
+		level = (unsigned int)(density * (1u << INIT_DENSITY_BITS) + 0.5);
+
+	uint64_t* bits = new uint64_t[(size_t)words_per_row * height]; // Every word is filled
+	ThreadPool pool(0);
+	unsigned int chunks = pool.ThreadCount() * 4;
+	TaskGroup group;
+	for (unsigned int c = 0; c < chunks; c++) {
+		unsigned int y0 = (unsigned int)((unsigned long long)height * c / chunks);
+		unsigned int y1 = (unsigned int)((unsigned long long)height * (c + 1) / chunks);
+		pool.Submit(group, [=] {
+			for (unsigned int y = y0; y < y1; y++)
+				FillRow(bits + (size_t)y * words_per_row, words_per_row, y, level, tail_mask);
+		});
+	}
+	pool.Wait(group);
+
+	LoadStateBitmap(bits, words_per_row);
+	delete[] bits;
+}
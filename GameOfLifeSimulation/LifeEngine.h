@@ -0,0 +1,48 @@
+#pragma once
+
+#include "IsotropicRule.h"
+#include "LtLRule.h"
+#include "Pattern.h"
+
+#include <cstddef>
+#include <cstdint>
+
+// Init's density is rounded to a multiple of 1 / 2^INIT_DENSITY_BITS
+#define INIT_DENSITY_BITS 16
+
+// A cell position, for the batched calls
+struct CellCoord
+{
+	unsigned int x;
+	unsigned int y;
+};
+
+// LifeEngine is the interface every simulation engine implements so
+// that main() can pick one at startup without caring how cells are stored.
+// Engines draw the cells that change in NextGen() themselves via DrawCell.
+class LifeEngine
+{
+public:
+	LifeEngine(unsigned int w, unsigned int h);
+	virtual ~LifeEngine();
+	virtual void SetCell(unsigned int x, unsigned int y) = 0;
+	virtual void ClearCell(unsigned int x, unsigned int y) = 0;
+	virtual int CellState(int x, int y) = 0;
+	virtual void NextGen() = 0;
+	virtual void SetCells(const CellCoord* coords, size_t count); // Cells already on (or repeated) are skipped
+	virtual void ClearCells(const CellCoord* coords, size_t count); // Cells already off (or repeated) are skipped
+	void Stamp(const Pattern& pattern, int x, int y, Transform transform = TRANSFORM_NONE);
+	virtual void Init();
+	virtual void LoadStateBitmap(const uint64_t* bitmap, unsigned int words_per_row); // Bulk SetCell on a clear map
+	virtual void SaveStateBitmap(uint64_t* bitmap, unsigned int words_per_row); // Bulk CellState
+	virtual void PrintStats() {} // Engine specific counters, printed on exit
+	virtual uint64_t GenerationsAdvanced() const { return 1; } // By the last NextGen
+	virtual bool SetRule(const LifeRule& rule) { return rule.IsConway(); } // False if the engine can't run the rule
+	virtual bool SetIsotropicRule(const IsotropicRule& rule) { return false; } // Non-totalistic rules
+	virtual bool SetLtLRule(const LtLRule& rule) { return false; } // Larger than Life rules
+	unsigned int Width() const { return width; }
+	unsigned int Height() const { return height; }
+protected:
+	unsigned int width;
+	unsigned int height;
+};
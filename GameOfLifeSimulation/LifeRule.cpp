@@ -0,0 +1,93 @@
+#include "LifeRule.h"
+
+#include <cctype>
+
+LifeRule::LifeRule()
+{
+	birth = 1 << 3;
+	survive = (1 << 2) | (1 << 3);
+	states = 2;
+	Compile();
+}
+
+// Builds the table of next states from the birth and survival counts
+void LifeRule::Compile()
+{
+	for (unsigned int i = 0; i <= RULE_INDEX_MASK; i++) {
+		unsigned int count = i >> 1;
+		if (i & 0x01)
+			next[i] = (survive >> count) & 1;
+		else
+			next[i] = (birth >> count) & 1;
+	}
+}
+
+// Parses a rulestring, leaving the rule unchanged if it is not valid
+bool LifeRule::Parse(const char* rulestring)
+{
+	unsigned int counts[2] = { 0, 0 }; // Birth, survival
+	unsigned int state_count = 2;
+	const char* p = rulestring;
+
+	if (toupper(*p) == 'B' || toupper(*p) == 'S') {
+
+		// B/S notation: a letter followed by its counts, in either order,
+		// optionally separated by a slash, then optionally C (or G) and
+		// the number of states
+		bool seen[3] = { false, false, false };
+		while (*p) {
+			char letter = (char)toupper(*p);
+			int part = (letter == 'B') ? 0 : (letter == 'S') ? 1 : (letter == 'C' || letter == 'G') ? 2 : -1;
+			if (part < 0 || seen[part])
+				return false;
+			seen[part] = true;
+			if (part == 2) {
+				if (!ParseStates(++p, state_count))
+					return false;
+			}
+			else {
+				for (p++; *p >= '0' && *p <= '8'; p++)
+					counts[part] |= 1 << (*p - '0');
+			}
+			if (*p == '/' && p[1] != '\0')
+				p++;
+		}
+	}
+	else {
+
+		// Survival/birth notation: digits, a slash, digits, and optionally
+		// a slash and the number of states
+		for (; *p >= '0' && *p <= '8'; p++)
+			counts[1] |= 1 << (*p - '0');
+		if (*p++ != '/')
+			return false;
+		for (; *p >= '0' && *p <= '8'; p++)
+			counts[0] |= 1 << (*p - '0');
+		if (*p == '/' && !ParseStates(++p, state_count))
+			return false;
+		if (*p != '\0')
+			return false;
+	}
+
+	if (counts[0] & 1)
+		return false;
+
+	birth = counts[0];
+	survive = counts[1];
+	states = state_count;
+	Compile();
+	return true;
+}
+
+// Reads the number of states of a Generations rule, advancing p past it
+bool LifeRule::ParseStates(const char*& p, unsigned int& state_count)
+{
+	if (*p < '0' || *p > '9')
+		return false;
+	for (state_count = 0; *p >= '0' && *p <= '9'; p++) {
+		state_count = state_count * 10 + (*p - '0');
+		if (state_count > RULE_MAX_STATES)
+			return false;
+	}
+	return state_count >= 2;
+}
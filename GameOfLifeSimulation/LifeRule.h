@@ -0,0 +1,30 @@
+#pragma once
+
+// Index into LifeRule::next for a cell byte: state in bit 0, count in bits 1-4
+#define RULE_INDEX_MASK 0x1F
+// Most states a Generations rule can have: on, off and up to 7 dying
+// states, which is what fits in the spare bits 5-7 of a cell byte
+#define RULE_MAX_STATES 9
+
+// LifeRule is a Life-like (outer totalistic) rule in B/S notation, e.g.
+// "B3/S23" for Conway's Life or "B36/S23" for HighLife. The older
+// survival/birth form "23/3" is also accepted. A third part gives the
+// number of states of a Generations rule, e.g. "B2/S/C3" or "/2/3" for
+// Brian's Brain: a cell that does not survive spends states - 2
+// generations dying, when it is neither counted as a neighbour nor able
+// to be born, before it is off. Rules with B0 are rejected, as the
+// engines skip dead cells with no neighbours.
+struct LifeRule
+{
+	LifeRule(); // Conway's Life
+	bool Parse(const char* rulestring);
+	bool IsConway() const { return birth == (1 << 3) && survive == ((1 << 2) | (1 << 3)) && states == 2; }
+
+	unsigned int birth; // Bit n set if a dead cell with n neighbours is born
+	unsigned int survive; // Bit n set if a live cell with n neighbours survives
+	unsigned int states; // 2 for Life-like rules, more for Generations rules
+	unsigned char next[RULE_INDEX_MASK + 1]; // Next state for each cell byte & RULE_INDEX_MASK
+private:
+	void Compile();
+	static bool ParseStates(const char*& p, unsigned int& state_count);
+};
@@ -0,0 +1,142 @@
+#include "LtLMap.h"
+#include "Common.h"
+
+#include <cstring>
+
+LtLMap::LtLMap(unsigned int w, unsigned int h) : LifeEngine(w, h)
+{
+	cells = new unsigned char[w * h];  // cell storage
+	next_cells = new unsigned char[w * h]; // next generation storage
+	memset(cells, 0, w * h);  // clear all cells, to start
+	row_sums = NULL;
+	box_sums = new unsigned int[w];
+	SetRule(LifeRule());
+}
+
+LtLMap::~LtLMap()
+{
+	delete[] cells;
+	delete[] next_cells;
+	delete[] row_sums;
+	delete[] box_sums;
+}
+
+void LtLMap::SetCell(unsigned int x, unsigned int y)
+{
+	cells[y * width + x] = 1;
+}
+
+void LtLMap::ClearCell(unsigned int x, unsigned int y)
+{
+	cells[y * width + x] = 0;
+}
+
+// Spreads each bitmap word out to 64 cell bytes
+void LtLMap::LoadStateBitmap(const uint64_t* bitmap, unsigned int words_per_row)
+{
+	for (unsigned int y = 0; y < height; y++) {
+		const uint64_t* row = bitmap + (size_t)y * words_per_row;
+		unsigned char* cell_ptr = cells + y * width;
+		for (unsigned int x = 0; x < width; x++)
+			cell_ptr[x] = (unsigned char)((row[x / 64] >> (x % 64)) & 1);
+	}
+}
+
+int LtLMap::CellState(int x, int y)
+{
+	return cells[y * width + x];
+}
+
+bool LtLMap::SetRule(const LifeRule& rule)
+{
+	if (rule.states != 2)
+		return false;
+	return SetLtLRule(LtLRule(rule));
+}
+
+// Fails if the box around a cell doesn't fit in the map
+bool LtLMap::SetLtLRule(const LtLRule& rule)
+{
+	unsigned int box = 2 * rule.range + 1;
+	if (box > width || box > height)
+		return false;
+
+	// Next state indexed by box sum * 2 + state; the box sum of a live cell
+	// includes the cell itself, which only counts with M1
+	this->rule = rule;
+	next_state.assign(2 * (rule.MaxCount() + 1), 0);
+	for (unsigned int count = 0; count <= rule.MaxCount(); count++) {
+		next_state[2 * count] = rule.birth[count];
+		if (count >= 1)
+			next_state[2 * count + 1] = rule.survive[rule.middle ? count : count - 1];
+	}
+	delete[] row_sums;
+	row_sums = new unsigned short[box * width];
+	return true;
+}
+
+// Replaces the row sums in sums with those of row y, updating the box
+// sums to match
+void LtLMap::EnterRow(unsigned int y, unsigned short* sums)
+{
+	unsigned int w = width, r = rule.range;
+	const unsigned char* row = cells + y * w;
+	unsigned int x, enter, leave;
+	unsigned int sum = 0;
+
+	// Sum of the cells around the first cell, wrapping around to the end
+	for (x = 0; x <= r; x++)
+		sum += row[x];
+	for (x = w - r; x < w; x++)
+		sum += row[x];
+
+	// Slide along the row: one cell enters on the right, one leaves on the left
+	enter = r + 1;
+	leave = w - r;
+	for (x = 0; x < w; x++) {
+		box_sums[x] += sum - sums[x];
+		sums[x] = (unsigned short)sum;
+		sum += row[enter] - row[leave];
+		if (++enter == w)
+			enter = 0;
+		if (++leave == w)
+			leave = 0;
+	}
+}
+
+void LtLMap::NextGen()
+{
+	unsigned int w = width, h = height, r = rule.range, box = 2 * r + 1;
+	unsigned int x, y, k;
+	const unsigned char* next_ptr = &next_state[0];
+	unsigned char* swap;
+
+	// Fill the box for row 0 with rows -R to R (wrapping); slot k of the
+	// ring holds row k - R
+	memset(row_sums, 0, box * w * sizeof(unsigned short));
+	memset(box_sums, 0, w * sizeof(unsigned int));
+	for (k = 0; k < box; k++)
+		EnterRow((k + h - r) % h, row_sums + k * w);
+
+	for (y = 0; y < h; y++) {
+
+		const unsigned char* row = cells + y * w;
+		unsigned char* next_row = next_cells + y * w;
+
+		for (x = 0; x < w; x++) {
+			unsigned char cell = row[x];
+			unsigned char next = next_ptr[box_sums[x] * 2 + cell];
+			next_row[x] = next;
+			if (next != cell)
+				DrawCell(x, y, next ? ON_COLOUR : OFF_COLOUR);
+		}
+
+		// Move the box down: row y - R leaves and row y + R + 1 takes its slot
+		if (y + 1 < h)
+			EnterRow((y + r + 1) % h, row_sums + (y % box) * w);
+	}
+
+	swap = cells;
+	cells = next_cells;
+	next_cells = swap;
+}
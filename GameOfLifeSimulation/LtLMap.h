@@ -0,0 +1,47 @@
+#pragma once
+
+#include "LifeEngine.h"
+#include "LtLRule.h"
+
+#include <vector>
+
+// LARGER THAN LIFE STRUCTURE
+/*
+Cells are stored one byte per cell (0 or 1) in a cells/next_cells pair,
+wrapping around at the edges like CellMap. A range R rule counts the
+(2R + 1) x (2R + 1) box around each cell, so counting directly would
+cost O(R^2) per cell. Instead the count is built from running sums:
+	- a row sum is the sum of the 2R + 1 cells centred on a cell in its
+	  row, found by sliding: add the cell entering on the right, take
+	  away the one leaving on the left;
+	- a box sum is the sum of the 2R + 1 row sums centred on a cell in
+	  its column. Moving down a row adds the row sums of the row entering
+	  at the bottom and takes away those of the row leaving at the top.
+Only the row sums of the 2R + 1 rows in the box are kept, in a ring, so
+each cell costs the same whatever R is. The box must fit in the map
+(2R + 1 no more than the width or height) or cells would count twice.
+*/
+
+// LtLMap runs Larger than Life rules with running box sums
+class LtLMap final : public LifeEngine
+{
+public:
+	LtLMap(unsigned int w, unsigned int h);
+	~LtLMap();
+	void SetCell(unsigned int x, unsigned int y);
+	void ClearCell(unsigned int x, unsigned int y);
+	int CellState(int x, int y);
+	void LoadStateBitmap(const uint64_t* bitmap, unsigned int words_per_row);
+	void NextGen();
+	bool SetRule(const LifeRule& rule);
+	bool SetLtLRule(const LtLRule& rule);
+private:
+	void EnterRow(unsigned int y, unsigned short* sums);
+
+	LtLRule rule;
+	std::vector<unsigned char> next_state; // Indexed by box sum * 2 + state
+	unsigned char* cells;
+	unsigned char* next_cells;
+	unsigned short* row_sums; // Row sums of the 2R + 1 rows in the box, as a ring
+	unsigned int* box_sums; // Box sum of each cell in the row being processed
+};
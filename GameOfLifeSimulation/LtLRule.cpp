@@ -0,0 +1,99 @@
+#include "LtLRule.h"
+
+#include <cctype>
+#include <cstdlib>
+
+LtLRule::LtLRule() : LtLRule(LifeRule())
+{
+}
+
+// The same rule on the range 1 neighbourhood, without the middle cell
+LtLRule::LtLRule(const LifeRule& rule)
+{
+	range = 1;
+	middle = false;
+	birth.assign(MaxCount() + 1, 0);
+	survive.assign(MaxCount() + 1, 0);
+	for (unsigned int count = 0; count <= 8; count++) {
+		birth[count] = (rule.birth >> count) & 1;
+		survive[count] = (rule.survive >> count) & 1;
+	}
+}
+
+// Reads a number, advancing p past it; false if there are no digits
+static bool ParseNumber(const char*& p, unsigned int& n)
+{
+	if (*p < '0' || *p > '9')
+		return false;
+	char* end;
+	unsigned long value = strtoul(p, &end, 10);
+	if (value > 1000000000UL)
+		return false;
+	n = (unsigned int)value;
+	p = end;
+	return true;
+}
+
+// Parses a rulestring, leaving the rule unchanged if it is not valid
+bool LtLRule::Parse(const char* rulestring)
+{
+	unsigned int new_range = 0, states = 0, mid = 0;
+	unsigned int limits[2][2]; // Birth, survival: lowest and highest count
+	bool seen[2] = { false, false };
+	const char* p = rulestring;
+
+	// Comma separated parts, each a letter and its value
+	while (*p) {
+		char letter = (char)toupper(*p++);
+		if (letter == 'R') {
+			if (!ParseNumber(p, new_range))
+				return false;
+		}
+		else if (letter == 'C') {
+			if (!ParseNumber(p, states))
+				return false;
+		}
+		else if (letter == 'M') {
+			if (!ParseNumber(p, mid) || mid > 1)
+				return false;
+		}
+		else if (letter == 'N') {
+			if (toupper(*p++) != 'M')
+				return false; // Only the Moore neighbourhood
+		}
+		else if (letter == 'B' || letter == 'S') {
+
+			// A range of counts, lowest..highest, or a single count
+			int part = (letter == 'B') ? 0 : 1;
+			if (!ParseNumber(p, limits[part][0]))
+				return false;
+			limits[part][1] = limits[part][0];
+			if (p[0] == '.' && p[1] == '.') {
+				p += 2;
+				if (!ParseNumber(p, limits[part][1]))
+					return false;
+			}
+			seen[part] = true;
+		}
+		else
+			return false;
+
+		if (*p == ',' && p[1] != '\0')
+			p++;
+		else if (*p != '\0')
+			return false;
+	}
+
+	if (new_range < 1 || new_range > LTL_MAX_RANGE || states > 2 || !seen[0] || !seen[1])
+		return false;
+
+	range = new_range;
+	middle = (mid == 1);
+	birth.assign(MaxCount() + 1, 0);
+	survive.assign(MaxCount() + 1, 0);
+	for (unsigned int count = 0; count <= MaxCount(); count++) {
+		birth[count] = (count >= limits[0][0] && count <= limits[0][1]);
+		survive[count] = (count >= limits[1][0] && count <= limits[1][1]);
+	}
+	return true;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "LifeRule.h"
+
+#include <vector>
+
+// Largest neighbourhood range accepted
+#define LTL_MAX_RANGE 500
+
+// LtLRule is a Larger than Life rule: an outer totalistic rule on the
+// (2R + 1) x (2R + 1) box around each cell, in Golly's notation, e.g.
+// "R5,C0,M1,S34..58,B34..45,NM" for Bosco's Rule. M1 counts the cell
+// itself as one of its neighbours. Only two-state (C0 or C2) rules on
+// the Moore (box) neighbourhood are accepted. Life-like rules are the
+// range 1 case.
+struct LtLRule
+{
+	LtLRule(); // Conway's Life
+	LtLRule(const LifeRule& rule);
+	bool Parse(const char* rulestring);
+	unsigned int MaxCount() const { return (2 * range + 1) * (2 * range + 1); }
+
+	unsigned int range;
+	bool middle; // The cell counts itself
+	std::vector<unsigned char> birth; // Non-zero if a dead cell with this count is born
+	std::vector<unsigned char> survive; // Non-zero if a live cell with this count survives
+};
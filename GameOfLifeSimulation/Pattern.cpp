@@ -0,0 +1,71 @@
+#include "Pattern.h"
+
+#include <cstddef>
+
+Pattern::Pattern() : Pattern(0, 0)
+{
+}
+
+Pattern::Pattern(unsigned int w, unsigned int h)
+{
+	width = w;
+	height = h;
+	words_per_row = (w + 63) / 64;
+	bits.assign((size_t)words_per_row * h, 0);
+}
+
+void Pattern::SetCell(unsigned int x, unsigned int y)
+{
+	bits[(size_t)y * words_per_row + x / 64] |= 1ULL << (x % 64);
+}
+
+int Pattern::CellState(unsigned int x, unsigned int y) const
+{
+	return (bits[(size_t)y * words_per_row + x / 64] >> (x % 64)) & 1;
+}
+
+// Parses a plaintext pattern, leaving the pattern unchanged if it is not valid
+bool Pattern::Parse(const char* text)
+{
+	unsigned int w = 0, h = 0, x;
+	const char* p;
+
+	// Size the pattern first: the longest row by the number of rows
+	for (p = text; *p; ) {
+		bool comment = (*p == '!');
+		for (x = 0; *p && *p != '\n'; p++) {
+			if (comment || *p == '\r')
+				continue;
+			if (*p != '.' && *p != 'O' && *p != '*')
+				return false;
+			x++;
+		}
+		if (*p == '\n')
+			p++;
+		if (!comment) {
+			if (x > w)
+				w = x;
+			h++;
+		}
+	}
+
+	Pattern parsed(w, h);
+	unsigned int y = 0;
+	for (p = text; *p; ) {
+		bool comment = (*p == '!');
+		for (x = 0; *p && *p != '\n'; p++) {
+			if (comment || *p == '\r')
+				continue;
+			if (*p != '.')
+				parsed.SetCell(x, y);
+			x++;
+		}
+		if (*p == '\n')
+			p++;
+		if (!comment)
+			y++;
+	}
+
+	*this = parsed;
+	return true;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Rotations (clockwise) and reflections a pattern can be stamped with
+enum Transform
+{
+	TRANSFORM_NONE,
+	TRANSFORM_ROTATE_90,
+	TRANSFORM_ROTATE_180,
+	TRANSFORM_ROTATE_270,
+	TRANSFORM_FLIP_X, // Mirrored left to right
+	TRANSFORM_FLIP_Y, // Mirrored top to bottom
+	TRANSFORM_FLIP_DIAGONAL, // Mirrored about the diagonal through the top left
+	TRANSFORM_FLIP_ANTIDIAGONAL // Mirrored about the diagonal through the top right
+};
+
+// Pattern is a rectangle of cells to stamp into a map, one bit per cell
+// laid out as for LifeEngine::LoadStateBitmap. Parse reads the plaintext
+// (.cells) format: lines starting with '!' are comments and every other
+// line is a row, with 'O' (or '*') for a live cell and '.' for a dead
+// one. Short rows are padded with dead cells.
+struct Pattern
+{
+	Pattern(); // Empty
+	Pattern(unsigned int w, unsigned int h); // All dead
+	bool Parse(const char* text);
+	void SetCell(unsigned int x, unsigned int y);
+	int CellState(unsigned int x, unsigned int y) const;
+
+	unsigned int width;
+	unsigned int height;
+	unsigned int words_per_row;
+	std::vector<uint64_t> bits;
+};
@@ -0,0 +1,37 @@
+// Philox4x32-10 counter-based random number generator
+#pragma once
+
+#include <cstdint>
+
+// Philox (Salmon et al., "Parallel Random Numbers: As Easy as 1, 2, 3")
+// turns a 128-bit counter and 64-bit key into four random 32-bit words
+// with ten rounds of multiplies and xors. Any word can be found directly
+// from its counter, so cells can draw their random numbers in any order,
+// on any thread, and still get the same ones.
+#define PHILOX_M0 0xD2511F53u
+#define PHILOX_M1 0xCD9E8D57u
+#define PHILOX_W0 0x9E3779B9u // Key increments between rounds
+#define PHILOX_W1 0xBB67AE85u
+#define PHILOX_ROUNDS 10
+
+// Fills out with the four words for counter ctr under key
+inline void Philox4x32(const uint32_t ctr[4], const uint32_t key[2], uint32_t out[4])
+{
+	uint32_t c0 = ctr[0], c1 = ctr[1], c2 = ctr[2], c3 = ctr[3];
+	uint32_t k0 = key[0], k1 = key[1];
+
+	for (int round = 0; round < PHILOX_ROUNDS; round++) {
+		uint64_t p0 = (uint64_t)PHILOX_M0 * c0;
+		uint64_t p1 = (uint64_t)PHILOX_M1 * c2;
+		c0 = (uint32_t)(p1 >> 32) ^ c1 ^ k0;
+		c1 = (uint32_t)p1;
+		c2 = (uint32_t)(p0 >> 32) ^ c3 ^ k1;
+		c3 = (uint32_t)p0;
+		k0 += PHILOX_W0;
+		k1 += PHILOX_W1;
+	}
+	out[0] = c0;
+	out[1] = c1;
+	out[2] = c2;
+	out[3] = c3;
+}
@@ -0,0 +1,130 @@
+#include "PipelineMap.h"
+#include "Common.h"
+
+#include <cstring>
+#include <iostream>
+
+using namespace std;
+
+PipelineMap::PipelineMap(unsigned int w, unsigned int h, unsigned int threads) : LifeEngine(w, h), pool(threads)
+{
+	// One stage per thread; each stage must have a thread of its own as
+	// it waits on the one before it
+	stages = pool.ThreadCount();
+	for (unsigned int i = 0; i <= stages; i++)
+		maps.push_back(new unsigned char[w * h]);
+	memset(maps[0], 0, w * h);
+	progress = new atomic<unsigned int>[stages];
+	stalls.assign(stages, 0);
+}
+
+PipelineMap::~PipelineMap()
+{
+	for (unsigned int i = 0; i <= stages; i++)
+		delete[] maps[i];
+	delete[] progress;
+}
+
+void PipelineMap::SetCell(unsigned int x, unsigned int y)
+{
+	maps[0][y * width + x] = 1;
+}
+
+void PipelineMap::ClearCell(unsigned int x, unsigned int y)
+{
+	maps[0][y * width + x] = 0;
+}
+
+int PipelineMap::CellState(int x, int y)
+{
+	return maps[0][y * width + x];
+}
+
+// Next state of the cell at x given its row and the rows above and below,
+// with left and right the columns of its neighbours
+static inline unsigned char NextState(const unsigned char* above, const unsigned char* row, const unsigned char* below,
+	unsigned int left, unsigned int x, unsigned int right)
+{
+	unsigned char count = above[left] + above[x] + above[right] + row[left] + row[right] +
+		below[left] + below[x] + below[right];
+
+	// On cell stays on with 2 or 3 neighbours, off cell turns on with 3
+	return (count == 3) | ((count == 2) & row[x]);
+}
+
+// Computes row y of out from in, wrapping at the edges
+void PipelineMap::NextRow(const unsigned char* in, unsigned char* out, unsigned int y)
+{
+	const unsigned char* above = in + ((y == 0) ? height - 1 : y - 1) * width;
+	const unsigned char* row = in + y * width;
+	const unsigned char* below = in + ((y == height - 1) ? 0 : y + 1) * width;
+	unsigned char* next = out + y * width;
+	unsigned int x;
+
+	next[0] = NextState(above, row, below, width - 1, 0, (width > 1) ? 1 : 0);
+	for (x = 1; x + 1 < width; x++)
+		next[x] = NextState(above, row, below, x - 1, x, x + 1);
+	if (width > 1)
+		next[width - 1] = NextState(above, row, below, width - 2, width - 1, 0);
+}
+
+void PipelineMap::RunStage(unsigned int stage)
+{
+	const unsigned char* in = maps[stage];
+	unsigned char* out = maps[stage + 1];
+	unsigned int start = (height - (stages - 1 - stage) % height) % height;
+	unsigned int i, x;
+
+	for (i = 0; i < height; i++) {
+
+		// Wait until the previous stage has finished the rows this one reads
+		if (stage > 0) {
+			unsigned int need = (i + PIPELINE_LAG < height) ? i + PIPELINE_LAG : height;
+			if (progress[stage - 1].load(memory_order_acquire) < need) {
+				stalls[stage]++;
+				while (progress[stage - 1].load(memory_order_acquire) < need)
+					this_thread::yield();
+			}
+		}
+
+		unsigned int y = (start + i) % height;
+		NextRow(in, out, y);
+
+		// Draw the cells that changed over the whole NextGen
+		if (stage == stages - 1) {
+			const unsigned char* old = maps[0] + y * width;
+			const unsigned char* next = out + y * width;
+			for (x = 0; x < width; x++) {
+				if (next[x] != old[x])
+					DrawCell(x, y, next[x] ? ON_COLOUR : OFF_COLOUR);
+			}
+		}
+
+		progress[stage].store(i + 1, memory_order_release);
+	}
+}
+
+void PipelineMap::NextGen()
+{
+	unsigned int i;
+
+	for (i = 0; i < stages; i++)
+		progress[i].store(0, memory_order_relaxed);
+
+	TaskGroup group;
+	for (i = 0; i < stages; i++)
+		pool.Submit(group, [this, i] { RunStage(i); });
+	pool.Wait(group);
+
+	// The last generation becomes the current one
+	unsigned char* swap = maps[0];
+	maps[0] = maps[stages];
+	maps[stages] = swap;
+}
+
+void PipelineMap::PrintStats()
+{
+	cout << "Generations per frame: " << stages << endl;
+	for (unsigned int i = 1; i < stages; i++)
+		cout << "Stage " << i << " stalls: " << stalls[i] << endl;
+}
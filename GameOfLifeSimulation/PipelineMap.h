@@ -0,0 +1,53 @@
+#pragma once
+
+#include "LifeEngine.h"
+#include "ThreadPool.h"
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+// Rows a stage stays behind the stage before it
+#define PIPELINE_LAG 3
+
+// PIPELINE STRUCTURE
+/*
+Cells are stored one byte per cell (0 or 1). With n threads there are n
+stages and n + 1 maps: stage j reads map j and writes map j + 1, so one
+NextGen advances n generations with every stage working at once on a
+different generation. Each stage publishes how many rows it has
+finished, and stage j only computes a row once stage j - 1 has finished
+the row below it, trailing it by PIPELINE_LAG rows. The rows a stage
+has just produced are read by the next stage while they are still in
+cache.
+
+The map wraps, so the first row needs the last row of the previous
+generation. Stage j therefore starts n - 1 - j rows above row 0
+(wrapping round to the bottom of the map), one row above the stage
+after it; every row it needs from stage j - 1 is then at most
+PIPELINE_LAG rows into that stage's order. The last stage draws the
+cells that differ from map 0, which nothing writes during NextGen.
+*/
+
+// PipelineMap advances one generation per thread, pipelined row by row
+class PipelineMap final : public LifeEngine
+{
+public:
+	PipelineMap(unsigned int w, unsigned int h, unsigned int threads);
+	~PipelineMap();
+	void SetCell(unsigned int x, unsigned int y);
+	void ClearCell(unsigned int x, unsigned int y);
+	int CellState(int x, int y);
+	void NextGen();
+	void PrintStats();
+	uint64_t GenerationsAdvanced() const { return stages; }
+private:
+	void NextRow(const unsigned char* in, unsigned char* out, unsigned int y);
+	void RunStage(unsigned int stage);
+
+	ThreadPool pool;
+	unsigned int stages;
+	std::vector<unsigned char*> maps; // maps[0] is the current generation
+	std::atomic<unsigned int>* progress; // Rows each stage has finished this NextGen
+	std::vector<uint64_t> stalls; // Times each stage waited for the stage before it
+};
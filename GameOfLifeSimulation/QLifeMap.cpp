@@ -0,0 +1,174 @@
+// BASED ON DAVID STAFFORD'S QLIFE (GRAPHICS PROGRAMMING BLACK BOOK CHAPTER 18)
+#include "QLifeMap.h"
+#include "Common.h"
+
+#include <cstring>
+#include <iostream>
+
+using namespace std;
+
+#define TRIPLET_QUEUED 0x8000
+#define TRIPLET_STATES 0x0007
+#define COUNT_SHIFT(p) (3 + 4 * (p)) // Bit offset of cell p's neighbour count
+
+// Next bits 0-2 for every value of bits 0-14 of a triplet
+static unsigned char next_states[1 << 15];
+static bool next_states_built = false;
+
+static void BuildNextStates()
+{
+	for (unsigned int i = 0; i < (1 << 15); i++) {
+		unsigned int s[3], c[3], p, next = 0;
+		for (p = 0; p < 3; p++) {
+			s[p] = (i >> p) & 1;
+			c[p] = (i >> COUNT_SHIFT(p)) & 0xF;
+		}
+
+		// Add the neighbours inside the triplet
+		c[0] += s[1];
+		c[1] += s[0] + s[2];
+		c[2] += s[1];
+
+		for (p = 0; p < 3; p++) {
+			// On cell stays on with 2 or 3 neighbours, off cell turns on with 3
+			if (c[p] == 3 || (s[p] && c[p] == 2))
+				next |= 1 << p;
+		}
+		next_states[i] = (unsigned char)next;
+	}
+	next_states_built = true;
+}
+
+QLifeMap::QLifeMap(unsigned int w, unsigned int h) : LifeEngine(w, h)
+{
+	if (!next_states_built)
+		BuildNextStates();
+
+	triplets_per_row = (w + 2) / 3;
+	triplets = new uint16_t[triplets_per_row * h];
+	memset(triplets, 0, triplets_per_row * h * sizeof(uint16_t));
+	triplets_checked = 0;
+	generations = 0;
+}
+
+QLifeMap::~QLifeMap()
+{
+	delete[] triplets;
+}
+
+inline void QLifeMap::Queue(unsigned int t)
+{
+	if (!(triplets[t] & TRIPLET_QUEUED)) {
+		triplets[t] |= TRIPLET_QUEUED;
+		next_list.push_back(t);
+	}
+}
+
+// Changes the state of cell (x, y) by delta (+1 on, -1 off), updating the
+// outside-triplet counts of its neighbours and queueing every triplet touched
+void QLifeMap::FlipCell(unsigned int x, unsigned int y, int delta)
+{
+	unsigned int w = width, h = height;
+	unsigned int tx = x / 3;
+	unsigned int xs[3], ys[3], i, j;
+
+	// Shifts are done unsigned and the sign applied after, as shifting a
+	// negative value is undefined
+	uint16_t step = (uint16_t)(1u << (x % 3));
+	if (delta > 0)
+		triplets[y * triplets_per_row + tx] += step;
+	else
+		triplets[y * triplets_per_row + tx] -= step;
+	Queue(y * triplets_per_row + tx);
+
+	xs[0] = (x == 0) ? w - 1 : x - 1;
+	xs[1] = x;
+	xs[2] = (x == w - 1) ? 0 : x + 1;
+	ys[0] = (y == 0) ? h - 1 : y - 1;
+	ys[1] = y;
+	ys[2] = (y == h - 1) ? 0 : y + 1;
+
+	for (j = 0; j < 3; j++) {
+		for (i = 0; i < 3; i++) {
+			unsigned int nx = xs[i], ny = ys[j];
+			if (i == 1 && j == 1)
+				continue;
+
+			// Neighbours in the same triplet are counted by the table
+			if (j == 1 && nx / 3 == tx && (nx + 1 == x || nx == x + 1))
+				continue;
+
+			unsigned int t = ny * triplets_per_row + nx / 3;
+			step = (uint16_t)(1u << COUNT_SHIFT(nx % 3));
+			if (delta > 0)
+				triplets[t] += step;
+			else
+				triplets[t] -= step;
+			Queue(t);
+		}
+	}
+}
+
+void QLifeMap::SetCell(unsigned int x, unsigned int y)
+{
+	if (!CellState(x, y))
+		FlipCell(x, y, 1);
+}
+
+void QLifeMap::ClearCell(unsigned int x, unsigned int y)
+{
+	if (CellState(x, y))
+		FlipCell(x, y, -1);
+}
+
+int QLifeMap::CellState(int x, int y)
+{
+	return (triplets[y * triplets_per_row + x / 3] >> (x % 3)) & 1;
+}
+
+void QLifeMap::NextGen()
+{
+	size_t n;
+
+	// Triplets queued by SetCell/ClearCell or last generation's flips
+	change_list.swap(next_list);
+	next_list.clear();
+
+	// Look up every queued triplet before changing any of them
+	flips.clear();
+	for (n = 0; n < change_list.size(); n++) {
+		unsigned int t = change_list[n];
+		uint16_t word = triplets[t] & ~TRIPLET_QUEUED;
+		triplets[t] = word;
+
+		unsigned int states = next_states[word];
+		if (states != (word & TRIPLET_STATES)) {
+			PendingFlip f = { t, states };
+			flips.push_back(f);
+		}
+	}
+	triplets_checked += change_list.size();
+
+	// Apply the flips, queueing the triplets they touch for next generation
+	for (n = 0; n < flips.size(); n++) {
+		unsigned int t = flips[n].triplet;
+		unsigned int y = t / triplets_per_row, x0 = (t % triplets_per_row) * 3;
+		unsigned int old_states = triplets[t] & TRIPLET_STATES;
+		unsigned int changed = old_states ^ flips[n].states;
+
+		for (unsigned int p = 0; p < 3; p++) {
+			if (changed & (1 << p)) {
+				bool on = (flips[n].states >> p) & 1;
+				FlipCell(x0 + p, y, on ? 1 : -1);
+				DrawCell(x0 + p, y, on ? ON_COLOUR : OFF_COLOUR);
+			}
+		}
+	}
+
+	generations++;
+}
+
+void QLifeMap::PrintStats()
+{
+	cout << "Average triplets checked: " << (generations ? (double)triplets_checked / generations : 0.0) << endl;
+}
@@ -0,0 +1,54 @@
+// BASED ON DAVID STAFFORD'S QLIFE (GRAPHICS PROGRAMMING BLACK BOOK CHAPTER 18)
+#pragma once
+
+#include "LifeEngine.h"
+
+#include <cstdint>
+#include <vector>
+
+// TRIPLET STRUCTURE
+/*
+Cells are stored three to a 16-bit word (a triplet of horizontally
+adjacent cells; the last triplet of a row is padded with dead cells
+when the width is not a multiple of 3):
+	bits 0-2	states of the left, middle and right cells
+	bits 3-6	left cell's count of neighbours outside the triplet
+	bits 7-10	middle cell's count of neighbours outside the triplet
+	bits 11-14	right cell's count of neighbours outside the triplet
+	bit 15		triplet is on the change list
+Neighbours inside the triplet are implied by bits 0-2, so the low 15
+bits fully determine the triplet's next state and are used to index a
+32768-entry table. Only triplets whose word changed last generation are
+looked up; the flips are then applied, updating the counts of the
+surrounding triplets and putting them on the next change list.
+*/
+
+// QLifeMap stores cells as triplets with a table-driven change list
+class QLifeMap final : public LifeEngine
+{
+public:
+	QLifeMap(unsigned int w, unsigned int h);
+	~QLifeMap();
+	void SetCell(unsigned int x, unsigned int y);
+	void ClearCell(unsigned int x, unsigned int y);
+	int CellState(int x, int y);
+	void NextGen();
+	void PrintStats();
+private:
+	struct PendingFlip
+	{
+		unsigned int triplet; // Offset of the triplet
+		unsigned int states; // Its new bits 0-2
+	};
+
+	void Queue(unsigned int t);
+	void FlipCell(unsigned int x, unsigned int y, int delta);
+
+	uint16_t* triplets;
+	unsigned int triplets_per_row;
+	std::vector<unsigned int> change_list; // Triplets whose word changed
+	std::vector<unsigned int> next_list;
+	std::vector<PendingFlip> flips;
+	uint64_t triplets_checked;
+	uint64_t generations;
+};
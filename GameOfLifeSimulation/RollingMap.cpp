@@ -0,0 +1,71 @@
+// BASED ON MICHAEL ABRASH'S GRAPHICS PROGRAMMING BLACK BOOK CHAPTER 17
+#include "RollingMap.h"
+
+#include <cstring>
+
+RollingMap::RollingMap(unsigned int w, unsigned int h) : CellMap(w, h, false)
+{
+	current_row = new unsigned char[w];
+	next_row = new unsigned char[w];
+	last_row = new unsigned char[w];
+}
+
+RollingMap::~RollingMap()
+{
+	delete[] current_row;
+	delete[] next_row;
+	delete[] last_row;
+}
+
+// Applies the rules to row y, given its unaltered cells
+void RollingMap::ProcessRow(const unsigned char* row, unsigned int y)
+{
+	unsigned int x = 0;
+	unsigned int w = width;
+	const unsigned char *cell_ptr = row;
+
+	do {
+
+		// Zero bytes are off and have no neighbours so skip them...
+		while (*cell_ptr == 0) {
+			cell_ptr++; // Advance to the next cell
+			// If all cells in row are off with no neighbours we're done
+			if (++x >= w) return;
+		}
+
+		// Remaining cells are either on or have neighbours
+		UpdateCell(x, y, *cell_ptr);
+
+		// Advance to the next cell byte
+		cell_ptr++;
+
+	} while (++x < w);
+}
+
+void RollingMap::NextGen()
+{
+	unsigned int w = width, h = height;
+	unsigned int y;
+	unsigned char *swap;
+
+	// Row 0 changes the last row, so save it before anything else
+	memcpy(last_row, cells + (h - 1) * w, w);
+	memcpy(current_row, cells, w);
+	bytes_copied += 2 * w;
+
+	for (y = 0; y < h; y++) {
+
+		// Save the next row before this one's changes reach it
+		if (y + 1 < h - 1) {
+			memcpy(next_row, cells + (y + 1) * w, w);
+			bytes_copied += w;
+		}
+
+		ProcessRow((y == h - 1 && h > 1) ? last_row : current_row, y);
+
+		swap = current_row;
+		current_row = next_row;
+		next_row = swap;
+	}
+	generations++;
+}
@@ -0,0 +1,31 @@
+// BASED ON MICHAEL ABRASH'S GRAPHICS PROGRAMMING BLACK BOOK CHAPTER 17
+#pragma once
+
+#include "CellMap.h"
+
+// ROLLING STRUCTURE
+/*
+Cells use the CellMap byte layout, but there is no temp_cells map.
+Rows are processed top to bottom, and a change in row y only touches
+rows y - 1 to y + 1. So when row y is reached, the unaltered version of
+it is only needed if row y - 1 has already changed it, and it is copied
+just before row y - 1 is processed. The last row is also touched by row
+0 (wrapping), so it is copied at the start. That leaves three rows of
+scratch space: the row being processed, the next row and the last row.
+The cell map then takes half the memory of CellMap.
+*/
+
+// RollingMap is a CellMap that keeps only three unaltered rows
+class RollingMap final : public CellMap
+{
+public:
+	RollingMap(unsigned int w, unsigned int h);
+	~RollingMap();
+	void NextGen();
+private:
+	void ProcessRow(const unsigned char* row, unsigned int y);
+
+	unsigned char* current_row; // Unaltered copy of the row being processed
+	unsigned char* next_row; // Unaltered copy of the row after it
+	unsigned char* last_row; // Unaltered copy of row height - 1
+};
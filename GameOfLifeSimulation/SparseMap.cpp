@@ -0,0 +1,216 @@
+#include "SparseMap.h"
+#include "BitOps.h"
+#include "Common.h"
+
+#include <cstring>
+#include <iostream>
+
+using namespace std;
+
+SparseMap::SparseMap(unsigned int w, unsigned int h) : LifeEngine(w, h)
+{
+	tiles_created = 0;
+	tiles_freed = 0;
+	peak_tiles = 0;
+}
+
+SparseMap::~SparseMap()
+{
+	for (auto it = tiles.begin(); it != tiles.end(); ++it)
+		delete it->second;
+}
+
+SparseMap::Tile* SparseMap::Find(int32_t tx, int32_t ty) const
+{
+	auto it = tiles.find(Key(tx, ty));
+	return (it == tiles.end()) ? NULL : it->second;
+}
+
+// Returns the tile at (tx, ty), creating an empty one if there is none
+SparseMap::Tile* SparseMap::Create(int32_t tx, int32_t ty)
+{
+	Tile*& t = tiles[Key(tx, ty)];
+	if (t == NULL) {
+		t = new Tile;
+		t->tx = tx;
+		t->ty = ty;
+		memset(t->rows, 0, sizeof(t->rows));
+		tiles_created++;
+		if (tiles.size() > peak_tiles)
+			peak_tiles = tiles.size();
+	}
+	return t;
+}
+
+void SparseMap::SetCell(unsigned int x, unsigned int y)
+{
+	Tile* t = Create(x / SPARSE_TILE, y / SPARSE_TILE);
+	t->rows[y % SPARSE_TILE] |= 1ULL << (x % SPARSE_TILE);
+}
+
+// Empty tiles are left for NextGen to free
+void SparseMap::ClearCell(unsigned int x, unsigned int y)
+{
+	Tile* t = Find(x / SPARSE_TILE, y / SPARSE_TILE);
+	if (t != NULL)
+		t->rows[y % SPARSE_TILE] &= ~(1ULL << (x % SPARSE_TILE));
+}
+
+int SparseMap::CellState(int x, int y)
+{
+	Tile* t = Find(x / SPARSE_TILE, y / SPARSE_TILE);
+	return (t != NULL) ? (t->rows[y % SPARSE_TILE] >> (x % SPARSE_TILE)) & 1 : 0;
+}
+
+// Creates the neighbours that cells on the tile's edges can give births in
+void SparseMap::AddNeighbours(const Tile* t)
+{
+	const int last = SPARSE_TILE - 1;
+	uint64_t top = t->rows[0], bottom = t->rows[last], sides = 0;
+
+	for (int r = 0; r < SPARSE_TILE; r++)
+		sides |= t->rows[r];
+
+	if (top)
+		Create(t->tx, t->ty - 1);
+	if (bottom)
+		Create(t->tx, t->ty + 1);
+	if (sides & 1)
+		Create(t->tx - 1, t->ty);
+	if (sides >> last)
+		Create(t->tx + 1, t->ty);
+	if (top & 1)
+		Create(t->tx - 1, t->ty - 1);
+	if (top >> last)
+		Create(t->tx + 1, t->ty - 1);
+	if (bottom & 1)
+		Create(t->tx - 1, t->ty + 1);
+	if (bottom >> last)
+		Create(t->tx + 1, t->ty + 1);
+}
+
+// Computes next_rows of the tile from its rows and its neighbours' edges
+void SparseMap::Advance(Tile* t)
+{
+	const int last = SPARSE_TILE - 1;
+	const Tile* n = Find(t->tx, t->ty - 1);
+	const Tile* s = Find(t->tx, t->ty + 1);
+	const Tile* w = Find(t->tx - 1, t->ty);
+	const Tile* e = Find(t->tx + 1, t->ty);
+	const Tile* nw = Find(t->tx - 1, t->ty - 1);
+	const Tile* ne = Find(t->tx + 1, t->ty - 1);
+	const Tile* sw = Find(t->tx - 1, t->ty + 1);
+	const Tile* se = Find(t->tx + 1, t->ty + 1);
+
+	// Row r - 1 to r + 1 of this column of tiles, with the cell either
+	// side of each (bit 0 of the east word, bit 63 of the west word)
+	uint64_t row[SPARSE_TILE + 2], west[SPARSE_TILE + 2], east[SPARSE_TILE + 2];
+	int r;
+
+	row[0] = n ? n->rows[last] : 0;
+	west[0] = nw ? nw->rows[last] : 0;
+	east[0] = ne ? ne->rows[last] : 0;
+	for (r = 0; r < SPARSE_TILE; r++) {
+		row[r + 1] = t->rows[r];
+		west[r + 1] = w ? w->rows[r] : 0;
+		east[r + 1] = e ? e->rows[r] : 0;
+	}
+	row[SPARSE_TILE + 1] = s ? s->rows[0] : 0;
+	west[SPARSE_TILE + 1] = sw ? sw->rows[0] : 0;
+	east[SPARSE_TILE + 1] = se ? se->rows[0] : 0;
+
+	// Words whose bit b holds the cell to the left / right of cell b
+	uint64_t left[SPARSE_TILE + 2], right[SPARSE_TILE + 2];
+	for (r = 0; r < SPARSE_TILE + 2; r++) {
+		left[r] = (row[r] << 1) | (west[r] >> last);
+		right[r] = (row[r] >> 1) | (east[r] << last);
+	}
+
+	for (r = 1; r <= SPARSE_TILE; r++) {
+		uint64_t s_above, c_above, s_below, c_below, s_mid, c_mid;
+		uint64_t ones, c_ones, twos_part, c_twos, twos, fours;
+
+		// Sum the three cells above, the three below and the two beside
+		FullAdd(left[r - 1], row[r - 1], right[r - 1], s_above, c_above);
+		FullAdd(left[r + 1], row[r + 1], right[r + 1], s_below, c_below);
+		s_mid = left[r] ^ right[r];
+		c_mid = left[r] & right[r];
+
+		// Combine into a 3-bit count (8 neighbours wraps to 0, which
+		// gives the same result as 8 for Conway's rules)
+		FullAdd(s_above, s_below, s_mid, ones, c_ones);
+		FullAdd(c_above, c_below, c_mid, twos_part, c_twos);
+		twos = twos_part ^ c_ones;
+		fours = c_twos ^ (twos_part & c_ones);
+
+		// Alive next if 3 neighbours, or 2 neighbours and already alive
+		t->next_rows[r - 1] = twos & ~fours & (ones | row[r]);
+	}
+}
+
+// Makes next_rows current, drawing the cells that changed in the window
+void SparseMap::Commit(Tile* t)
+{
+	int64_t x0 = (int64_t)t->tx * SPARSE_TILE, y0 = (int64_t)t->ty * SPARSE_TILE;
+	bool visible = x0 + SPARSE_TILE > 0 && x0 < width && y0 + SPARSE_TILE > 0 && y0 < height;
+
+	for (int r = 0; r < SPARSE_TILE; r++) {
+		uint64_t changed = t->rows[r] ^ t->next_rows[r];
+		int64_t y = y0 + r;
+
+		if (visible && y >= 0 && y < height) {
+			while (changed) {
+				unsigned int bit = LowestBit(changed);
+				int64_t x = x0 + bit;
+				if (x >= 0 && x < width)
+					DrawCell((unsigned int)x, (unsigned int)y, ((t->next_rows[r] >> bit) & 1) ? ON_COLOUR : OFF_COLOUR);
+				changed &= changed - 1;
+			}
+		}
+		t->rows[r] = t->next_rows[r];
+	}
+}
+
+void SparseMap::NextGen()
+{
+	size_t i;
+
+	// Make room for births beyond the edges of the live tiles
+	work.clear();
+	for (auto it = tiles.begin(); it != tiles.end(); ++it)
+		work.push_back(it->second);
+	for (i = 0; i < work.size(); i++)
+		AddNeighbours(work[i]);
+
+	work.clear();
+	for (auto it = tiles.begin(); it != tiles.end(); ++it)
+		work.push_back(it->second);
+	for (i = 0; i < work.size(); i++)
+		Advance(work[i]);
+
+	// Commit the new generation and free the tiles it left empty
+	for (auto it = tiles.begin(); it != tiles.end(); ) {
+		Tile* t = it->second;
+		uint64_t any = 0;
+
+		Commit(t);
+		for (int r = 0; r < SPARSE_TILE; r++)
+			any |= t->rows[r];
+
+		if (any == 0) {
+			delete t;
+			it = tiles.erase(it);
+			tiles_freed++;
+		}
+		else {
+			++it;
+		}
+	}
+}
+
+void SparseMap::PrintStats()
+{
+	cout << "Tiles live: " << tiles.size() << " (peak " << peak_tiles << ")"
+		<< "\nTiles created: " << tiles_created
+		<< "\nTiles freed: " << tiles_freed << endl;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "LifeEngine.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Width and height of a sparse tile in cells (one 64-bit word per row)
+#define SPARSE_TILE 64
+
+// SPARSE STRUCTURE
+/*
+The universe is an unbounded plane of SPARSE_TILE x SPARSE_TILE tiles,
+stored one bit per cell (cell x of a tile row in bit x of its word).
+Tiles are kept in a hash map keyed on their signed tile coordinates and
+only exist where there are live cells, so memory follows the pattern
+rather than its bounding box.
+
+Each NextGen first creates the neighbours of tiles with live cells on
+the matching edge or corner, since births can spill into them. Every
+tile is then advanced with bit-parallel adders, taking the cells beyond
+its edges from its eight neighbours (missing neighbours are dead).
+Finally the new generation is committed and tiles left empty are freed.
+*/
+
+// SparseMap shows the region [0, w) x [0, h) of an unbounded plane.
+// Like HashLifeMap the plane does not wrap around; cells that leave the
+// window keep evolving off screen.
+class SparseMap final : public LifeEngine
+{
+public:
+	SparseMap(unsigned int w, unsigned int h);
+	~SparseMap();
+	void SetCell(unsigned int x, unsigned int y);
+	void ClearCell(unsigned int x, unsigned int y);
+	int CellState(int x, int y);
+	void NextGen();
+	void PrintStats();
+private:
+	struct Tile
+	{
+		int32_t tx, ty; // Tile coordinates; the tile covers cells from (tx, ty) * SPARSE_TILE
+		uint64_t rows[SPARSE_TILE];
+		uint64_t next_rows[SPARSE_TILE];
+	};
+
+	static uint64_t Key(int32_t tx, int32_t ty) { return ((uint64_t)(uint32_t)tx << 32) | (uint32_t)ty; }
+	Tile* Find(int32_t tx, int32_t ty) const;
+	Tile* Create(int32_t tx, int32_t ty);
+	void AddNeighbours(const Tile* t);
+	void Advance(Tile* t);
+	void Commit(Tile* t);
+
+	std::unordered_map<uint64_t, Tile*> tiles;
+	std::vector<Tile*> work; // Tiles being processed this NextGen
+	uint64_t tiles_created;
+	uint64_t tiles_freed;
+	size_t peak_tiles;
+};
@@ -0,0 +1,85 @@
+#include "StealingTileMap.h"
+
+#include <cstring>
+
+StealingTileMap::StealingTileMap(unsigned int w, unsigned int h, unsigned int threads)
+	: TileMap(w, h), pool(threads)
+{
+	colour_x = ColourAxis(w, tiles_x, colours_x);
+	colour_y = ColourAxis(h, tiles_y, colours_y);
+	phase_tiles.resize(colours_x * colours_y);
+}
+
+// Greedily colours the tiles along one axis so that no two tiles of the
+// same colour have overlapping rings (the tile plus one cell either side,
+// wrapping)
+std::vector<unsigned int> StealingTileMap::ColourAxis(unsigned int cells, unsigned int tiles, unsigned int& colours)
+{
+	std::vector<unsigned int> colour(tiles);
+	std::vector<unsigned int> start(tiles), length(tiles);
+	unsigned int i, j;
+
+	for (i = 0; i < tiles; i++) {
+		unsigned int first = i * TILE_SIZE;
+		unsigned int last = (first + TILE_SIZE < cells) ? first + TILE_SIZE : cells;
+		start[i] = (first + cells - 1) % cells;
+		length[i] = (last - first + 2 < cells) ? last - first + 2 : cells;
+	}
+
+	colours = 0;
+	for (i = 0; i < tiles; i++) {
+		unsigned int c;
+		for (c = 0; ; c++) {
+			bool clash = false;
+			for (j = 0; j < i && !clash; j++) {
+				if (colour[j] != c)
+					continue;
+				clash = (start[j] + cells - start[i]) % cells < length[i] ||
+					(start[i] + cells - start[j]) % cells < length[j];
+			}
+			if (!clash)
+				break;
+		}
+		colour[i] = c;
+		if (c + 1 > colours)
+			colours = c + 1;
+	}
+
+	return colour;
+}
+
+void StealingTileMap::NextGen()
+{
+	unsigned int i;
+
+	FindActiveTiles();
+
+	// Copying a tile touches nothing else, so every active tile is one task
+	pool.Run(active, [this](unsigned int tile) { CopyTile(tile); });
+	for (i = 0; i < active.size(); i++)
+		bytes_copied += TileBytes(active[i]);
+
+	for (i = 0; i < phase_tiles.size(); i++)
+		phase_tiles[i].clear();
+	for (i = 0; i < active.size(); i++) {
+		unsigned int tile = active[i];
+		phase_tiles[colour_y[tile / tiles_x] * colours_x + colour_x[tile % tiles_x]].push_back(tile);
+	}
+
+	memset(next_changed, 0, tiles_x * tiles_y);
+	for (i = 0; i < phase_tiles.size(); i++)
+		pool.Run(phase_tiles[i], [this](unsigned int tile) { ProcessTile(tile); });
+
+	unsigned char* swap = changed;
+	changed = next_changed;
+	next_changed = swap;
+
+	tiles_processed += active.size();
+	generations++;
+}
+
+void StealingTileMap::PrintStats()
+{
+	TileMap::PrintStats();
+	pool.PrintStats();
+}
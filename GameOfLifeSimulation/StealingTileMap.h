@@ -0,0 +1,39 @@
+#pragma once
+
+#include "TileMap.h"
+#include "WorkStealingPool.h"
+
+#include <vector>
+
+// STEALING TILE STRUCTURE
+/*
+Cells and tiles are laid out as in TileMap, and only active tiles are
+processed. Processing a tile reads only its own cells of temp_cells,
+but SetCell/ClearCell also add to the counts in the ring of cells just
+outside it. Tiles are therefore coloured along each axis so that tiles
+of the same colour have disjoint rings (two colours normally, a third
+when the wraparound or a one cell wide edge tile would make rings meet),
+and each generation runs one phase per colour pair. Within a phase the
+active tiles of that colour are independent tasks, scheduled on a
+WorkStealingPool: when activity is concentrated in a few tiles the
+threads that run out of work take tiles from the busy ones instead of
+idling as static bands would.
+*/
+
+// StealingTileMap is a TileMap whose active tiles are processed on several threads
+class StealingTileMap final : public TileMap
+{
+public:
+	StealingTileMap(unsigned int w, unsigned int h, unsigned int threads);
+	void NextGen();
+	void PrintStats();
+private:
+	static std::vector<unsigned int> ColourAxis(unsigned int cells, unsigned int tiles, unsigned int& colours);
+
+	WorkStealingPool pool;
+	std::vector<unsigned int> colour_x; // Colour of each tile column
+	std::vector<unsigned int> colour_y; // Colour of each tile row
+	unsigned int colours_x;
+	unsigned int colours_y;
+	std::vector<std::vector<unsigned int> > phase_tiles; // Active tiles of each phase this generation
+};
@@ -0,0 +1,304 @@
+#include "StochasticMap.h"
+#include "Common.h"
+#include "Philox.h"
+
+#include <cstring>
+
+#if CPU_X86
+#include <immintrin.h>
+#endif
+
+// Random words below the threshold pass a test of probability p
+static uint64_t Threshold(double p)
+{
+	if (p <= 0.0)
+		return 0;
+	if (p >= 1.0)
+		return (uint64_t)1 << 32;
+	return (uint64_t)(p * 4294967296.0);
+}
+
+// A probability other than 0 or 1 needs random words
+static bool IsRandom(uint64_t threshold)
+{
+	return threshold != 0 && threshold != ((uint64_t)1 << 32);
+}
+
+StochasticMap::StochasticMap(unsigned int w, unsigned int h, unsigned int threads, double birth_p, double survive_p, double noise)
+	: LifeEngine(w, h), pool(threads)
+{
+	cells = new unsigned char[w * h];  // cell storage
+	next_cells = new unsigned char[w * h]; // next generation storage
+	memset(cells, 0, w * h);  // clear all cells, to start
+	generation = 0;
+
+	keep_threshold[0] = Threshold(birth_p);
+	keep_threshold[1] = Threshold(survive_p);
+	flip_threshold = Threshold(noise);
+	random = IsRandom(keep_threshold[0]) || IsRandom(keep_threshold[1]) || IsRandom(flip_threshold);
+
+	// Two bands per thread, each with its own scratch rows
+	unsigned int band_count = pool.ThreadCount() * 2;
+	if (band_count > h)
+		band_count = h;
+	unsigned int padded = (w + STOCHASTIC_PAD - 1) / STOCHASTIC_PAD * STOCHASTIC_PAD;
+	bands.resize(band_count);
+	for (unsigned int i = 0; i < band_count; i++) {
+		bands[i].y0 = (unsigned int)((unsigned long long)h * i / band_count);
+		bands[i].y1 = (unsigned int)((unsigned long long)h * (i + 1) / band_count);
+		bands[i].columns.assign(w + 2, 0);
+		bands[i].keep_words.assign(padded, 0);
+		bands[i].flip_words.assign(padded, 0);
+	}
+
+	SetKernel(KERNEL_AVX2); // widest available random word kernel
+	SetRule(LifeRule());
+}
+
+StochasticMap::~StochasticMap()
+{
+	delete[] cells;
+	delete[] next_cells;
+}
+
+void StochasticMap::SetCell(unsigned int x, unsigned int y)
+{
+	cells[y * width + x] = 1;
+}
+
+void StochasticMap::ClearCell(unsigned int x, unsigned int y)
+{
+	cells[y * width + x] = 0;
+}
+
+// Spreads each bitmap word out to 64 cell bytes
+void StochasticMap::LoadStateBitmap(const uint64_t* bitmap, unsigned int words_per_row)
+{
+	for (unsigned int y = 0; y < height; y++) {
+		const uint64_t* row = bitmap + (size_t)y * words_per_row;
+		unsigned char* cell_ptr = cells + y * width;
+		for (unsigned int x = 0; x < width; x++)
+			cell_ptr[x] = (unsigned char)((row[x / 64] >> (x % 64)) & 1);
+	}
+}
+
+int StochasticMap::CellState(int x, int y)
+{
+	return cells[y * width + x];
+}
+
+bool StochasticMap::SetRule(const LifeRule& rule)
+{
+	if (rule.states != 2)
+		return false; // No dying states in this engine
+	this->rule = rule;
+	return true;
+}
+
+// Picks the widest kernel this CPU supports, falling back towards scalar
+void StochasticMap::SetKernel(Kernel k)
+{
+	if (k == KERNEL_AVX2 && !CpuHasAVX2())
+		k = KERNEL_SSE2;
+	if (k == KERNEL_SSE2 && !CpuHasSSE2())
+		k = KERNEL_SCALAR;
+	kernel = k;
+}
+
+void StochasticMap::NextGen()
+{
+	unsigned char* swap;
+
+	// The seed is only known once Init has run
+	key[0] = seed;
+	key[1] = 0;
+
+	TaskGroup group;
+	for (size_t i = 0; i < bands.size(); i++)
+		pool.Submit(group, [this, i] { NextGenRows(bands[i]); });
+	pool.Wait(group);
+
+	swap = cells;
+	cells = next_cells;
+	next_cells = swap;
+	generation++;
+}
+
+void StochasticMap::NextGenRows(Band& band)
+{
+	unsigned int w = width, h = height;
+	unsigned int x, y;
+	unsigned char* columns = &band.columns[0];
+	const uint32_t* keep = &band.keep_words[0];
+	const uint32_t* flip = &band.flip_words[0];
+
+	for (y = band.y0; y < band.y1; y++) {
+
+		const unsigned char* up = cells + ((y == 0) ? h - 1 : y - 1) * w;
+		const unsigned char* row = cells + y * w;
+		const unsigned char* down = cells + ((y == h - 1) ? 0 : y + 1) * w;
+		unsigned char* next_row = next_cells + y * w;
+
+		// Column x is at columns[x + 1], with the last and first columns
+		// copied either side so the count needs no wraparound tests
+		for (x = 0; x < w; x++)
+			columns[x + 1] = up[x] + row[x] + down[x];
+		columns[0] = columns[w];
+		columns[w + 1] = columns[1];
+
+		if (random)
+			RandomRow(y, &band.keep_words[0], &band.flip_words[0]);
+
+		for (x = 0; x < w; x++) {
+			unsigned char cell = row[x];
+			unsigned int count = columns[x] + columns[x + 1] + columns[x + 2] - cell;
+			unsigned char next = rule.next[(count << 1) | cell];
+			next &= (unsigned char)(keep[x] < keep_threshold[cell]);
+			next ^= (unsigned char)(flip[x] < flip_threshold);
+			next_row[x] = next;
+			if (next != cell)
+				DrawCell(x, y, next ? ON_COLOUR : OFF_COLOUR);
+		}
+	}
+}
+
+// Fills keep and flip with the random words of row y this generation
+void StochasticMap::RandomRow(unsigned int y, uint32_t* keep, uint32_t* flip)
+{
+	switch (kernel) {
+	case KERNEL_AVX2:
+		RandomRowAVX2(y, keep, flip);
+		break;
+	case KERNEL_SSE2:
+		RandomRowSSE2(y, keep, flip);
+		break;
+	default:
+		RandomRowScalar(y, keep, flip);
+		break;
+	}
+}
+
+void StochasticMap::RandomRowScalar(unsigned int y, uint32_t* keep, uint32_t* flip)
+{
+	unsigned int counters = (width + STOCHASTIC_GROUP - 1) / STOCHASTIC_GROUP * 4;
+	uint32_t ctr[4] = { 0, y, (uint32_t)generation, (uint32_t)(generation >> 32) };
+	uint32_t out[4];
+
+	for (unsigned int n = 0; n < counters; n++) {
+		ctr[0] = n;
+		Philox4x32(ctr, key, out);
+		unsigned int x = STOCHASTIC_GROUP * (n / 4) + n % 4;
+		keep[x] = out[0];
+		flip[x] = out[1];
+		keep[x + 4] = out[2];
+		flip[x + 4] = out[3];
+	}
+}
+
+#if CPU_X86
+
+// High and low halves of each lane of a times m
+static inline void MulHiLo(__m128i a, __m128i m, __m128i& hi, __m128i& lo)
+{
+	__m128i even = _mm_mul_epu32(a, m); // Lanes 0 and 2 as 64-bit products
+	__m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), m); // Lanes 1 and 3
+	lo = _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+	hi = _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 3, 1)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 3, 1)));
+}
+
+// Four counters (eight cells) at once, one per lane
+void StochasticMap::RandomRowSSE2(unsigned int y, uint32_t* keep, uint32_t* flip)
+{
+	unsigned int counters = (width + STOCHASTIC_GROUP - 1) / STOCHASTIC_GROUP * 4;
+	const __m128i m0 = _mm_set1_epi32((int)PHILOX_M0);
+	const __m128i m1 = _mm_set1_epi32((int)PHILOX_M1);
+	const __m128i lanes = _mm_setr_epi32(0, 1, 2, 3);
+
+	for (unsigned int n = 0; n < counters; n += 4) {
+		__m128i c0 = _mm_add_epi32(_mm_set1_epi32((int)n), lanes);
+		__m128i c1 = _mm_set1_epi32((int)y);
+		__m128i c2 = _mm_set1_epi32((int)(uint32_t)generation);
+		__m128i c3 = _mm_set1_epi32((int)(uint32_t)(generation >> 32));
+		uint32_t k0 = key[0], k1 = key[1];
+
+		for (int round = 0; round < PHILOX_ROUNDS; round++) {
+			__m128i hi0, lo0, hi1, lo1;
+			MulHiLo(c0, m0, hi0, lo0);
+			MulHiLo(c2, m1, hi1, lo1);
+			c0 = _mm_xor_si128(_mm_xor_si128(hi1, c1), _mm_set1_epi32((int)k0));
+			c1 = lo1;
+			c2 = _mm_xor_si128(_mm_xor_si128(hi0, c3), _mm_set1_epi32((int)k1));
+			c3 = lo0;
+			k0 += PHILOX_W0;
+			k1 += PHILOX_W1;
+		}
+
+		unsigned int x = 2 * n;
+		_mm_storeu_si128((__m128i*)(keep + x), c0);
+		_mm_storeu_si128((__m128i*)(flip + x), c1);
+		_mm_storeu_si128((__m128i*)(keep + x + 4), c2);
+		_mm_storeu_si128((__m128i*)(flip + x + 4), c3);
+	}
+}
+
+static inline TARGET_AVX2 void MulHiLo(__m256i a, __m256i m, __m256i& hi, __m256i& lo)
+{
+	__m256i even = _mm256_mul_epu32(a, m);
+	__m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), m);
+	lo = _mm256_unpacklo_epi32(_mm256_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm256_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+	hi = _mm256_unpacklo_epi32(_mm256_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 3, 1)), _mm256_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 3, 1)));
+}
+
+// Eight counters (sixteen cells) at once; each 128-bit half holds the
+// words of one group of eight cells
+TARGET_AVX2 void StochasticMap::RandomRowAVX2(unsigned int y, uint32_t* keep, uint32_t* flip)
+{
+	unsigned int counters = (width + STOCHASTIC_PAD - 1) / STOCHASTIC_PAD * 8;
+	const __m256i m0 = _mm256_set1_epi32((int)PHILOX_M0);
+	const __m256i m1 = _mm256_set1_epi32((int)PHILOX_M1);
+	const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+	for (unsigned int n = 0; n < counters; n += 8) {
+		__m256i c0 = _mm256_add_epi32(_mm256_set1_epi32((int)n), lanes);
+		__m256i c1 = _mm256_set1_epi32((int)y);
+		__m256i c2 = _mm256_set1_epi32((int)(uint32_t)generation);
+		__m256i c3 = _mm256_set1_epi32((int)(uint32_t)(generation >> 32));
+		uint32_t k0 = key[0], k1 = key[1];
+
+		for (int round = 0; round < PHILOX_ROUNDS; round++) {
+			__m256i hi0, lo0, hi1, lo1;
+			MulHiLo(c0, m0, hi0, lo0);
+			MulHiLo(c2, m1, hi1, lo1);
+			c0 = _mm256_xor_si256(_mm256_xor_si256(hi1, c1), _mm256_set1_epi32((int)k0));
+			c1 = lo1;
+			c2 = _mm256_xor_si256(_mm256_xor_si256(hi0, c3), _mm256_set1_epi32((int)k1));
+			c3 = lo0;
+			k0 += PHILOX_W0;
+			k1 += PHILOX_W1;
+		}
+
+		unsigned int x = 2 * n;
+		_mm_storeu_si128((__m128i*)(keep + x), _mm256_castsi256_si128(c0));
+		_mm_storeu_si128((__m128i*)(flip + x), _mm256_castsi256_si128(c1));
+		_mm_storeu_si128((__m128i*)(keep + x + 4), _mm256_castsi256_si128(c2));
+		_mm_storeu_si128((__m128i*)(flip + x + 4), _mm256_castsi256_si128(c3));
+		_mm_storeu_si128((__m128i*)(keep + x + 8), _mm256_extracti128_si256(c0, 1));
+		_mm_storeu_si128((__m128i*)(flip + x + 8), _mm256_extracti128_si256(c1, 1));
+		_mm_storeu_si128((__m128i*)(keep + x + 12), _mm256_extracti128_si256(c2, 1));
+		_mm_storeu_si128((__m128i*)(flip + x + 12), _mm256_extracti128_si256(c3, 1));
+	}
+}
+
+#else
+
+void StochasticMap::RandomRowSSE2(unsigned int y, uint32_t* keep, uint32_t* flip)
+{
+	RandomRowScalar(y, keep, flip);
+}
+
+void StochasticMap::RandomRowAVX2(unsigned int y, uint32_t* keep, uint32_t* flip)
+{
+	RandomRowScalar(y, keep, flip);
+}
+
+#endif
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "LifeEngine.h"
+#include "CpuFeatures.h"
+#include "ThreadPool.h"
+
+#include <cstdint>
+#include <vector>
+
+// Cells whose random words come from one Philox counter group (4 counters, 8 cells)
+#define STOCHASTIC_GROUP 8
+// Row buffers are padded to a multiple of this (the widest SIMD kernel's step)
+#define STOCHASTIC_PAD 16
+
+// STOCHASTIC STRUCTURE
+/*
+Cells are stored one byte per cell (0 or 1) in a cells/next_cells pair,
+wrapping around at the edges like CellMap. Every cell is updated every
+generation:
+	1. the rule gives the deterministic next state from the count
+	2. a birth the rule allows happens with probability birth_p, and
+	   a survival with probability survive_p
+	3. the result is flipped with probability noise
+Each cell takes two random words, one for each test, from Philox4x32
+keyed by (seed, 0). The counter is (n, y, generation low, generation
+high): counter n of row y gives the words for cells 8 * (n / 4) + n % 4
+and that cell + 4, so four consecutive counters cover eight cells and
+SIMD lanes can store their words without shuffling. A cell's random
+numbers depend only on the seed, the generation and where it is, so
+the map after each generation is the same whatever the number of
+threads or SIMD kernel. Rows are split into bands run on a thread
+pool; each band only writes its own rows of next_cells.
+*/
+
+// StochasticMap runs Life-like rules with random births, survivals and noise
+class StochasticMap final : public LifeEngine
+{
+public:
+	StochasticMap(unsigned int w, unsigned int h, unsigned int threads, double birth_p, double survive_p, double noise);
+	~StochasticMap();
+	void SetCell(unsigned int x, unsigned int y);
+	void ClearCell(unsigned int x, unsigned int y);
+	int CellState(int x, int y);
+	void LoadStateBitmap(const uint64_t* bitmap, unsigned int words_per_row);
+	void NextGen();
+	bool SetRule(const LifeRule& rule);
+
+	// Random word kernels, widest first
+	enum Kernel { KERNEL_SCALAR, KERNEL_SSE2, KERNEL_AVX2 };
+	void SetKernel(Kernel k);
+	Kernel GetKernel() const { return kernel; }
+private:
+	// Scratch rows for one band
+	struct Band
+	{
+		unsigned int y0, y1;
+		std::vector<unsigned char> columns; // Sum of each column of three cells
+		std::vector<uint32_t> keep_words; // Tested against the birth or survival threshold
+		std::vector<uint32_t> flip_words; // Tested against the noise threshold
+	};
+
+	void NextGenRows(Band& band);
+	void RandomRow(unsigned int y, uint32_t* keep, uint32_t* flip);
+	void RandomRowScalar(unsigned int y, uint32_t* keep, uint32_t* flip);
+	void RandomRowSSE2(unsigned int y, uint32_t* keep, uint32_t* flip);
+	TARGET_AVX2 void RandomRowAVX2(unsigned int y, uint32_t* keep, uint32_t* flip);
+
+	ThreadPool pool;
+	std::vector<Band> bands;
+	Kernel kernel;
+	LifeRule rule;
+	uint64_t keep_threshold[2]; // Indexed by state: a word below it lets the rule's birth or survival happen
+	uint64_t flip_threshold; // A word below it flips the cell
+	bool random; // Any of the probabilities is strictly between 0 and 1
+	uint32_t key[2];
+	uint64_t generation;
+	unsigned char* cells;
+	unsigned char* next_cells;
+};
@@ -0,0 +1,166 @@
+#include "TemporalMap.h"
+#include "Common.h"
+
+#include <cstring>
+#include <iostream>
+
+using namespace std;
+
+TemporalMap::TemporalMap(unsigned int w, unsigned int h, unsigned int depth) : LifeEngine(w, h)
+{
+	if (depth == 0)
+		depth = 1;
+	if (depth > TEMPORAL_MAX_DEPTH)
+		depth = TEMPORAL_MAX_DEPTH;
+
+	this->depth = depth;
+	window_size = TEMPORAL_TILE + 2 * depth;
+	cells = new unsigned char[w * h];
+	next_cells = new unsigned char[w * h];
+	window = new unsigned char[window_size * window_size];
+	next_window = new unsigned char[window_size * window_size];
+	memset(cells, 0, w * h);
+	tiles_processed = 0;
+	tiles_skipped = 0;
+}
+
+TemporalMap::~TemporalMap()
+{
+	delete[] cells;
+	delete[] next_cells;
+	delete[] window;
+	delete[] next_window;
+}
+
+void TemporalMap::SetCell(unsigned int x, unsigned int y)
+{
+	cells[y * width + x] = 1;
+}
+
+void TemporalMap::ClearCell(unsigned int x, unsigned int y)
+{
+	cells[y * width + x] = 0;
+}
+
+int TemporalMap::CellState(int x, int y)
+{
+	return cells[y * width + x];
+}
+
+// Loads the tile at (x0, y0) and its halo into the window, wrapping at
+// the edges of the map. The window is a piece of the map repeated
+// periodically, so it may hold the same cell more than once on small
+// maps. Returns false if every loaded cell is dead.
+bool TemporalMap::LoadWindow(unsigned int x0, unsigned int y0)
+{
+	unsigned int s = window_size;
+	unsigned int left = (x0 + width - depth % width) % width;
+	unsigned int top = (y0 + height - depth % height) % height;
+	unsigned int i, j;
+	unsigned char any = 0;
+
+	for (i = 0; i < s; i++) {
+		const unsigned char* row = cells + ((top + i) % height) * width;
+		unsigned char* out = window + i * s;
+
+		if (left + s <= width) {
+			memcpy(out, row + left, s);
+		}
+		else {
+			for (j = 0; j < s; j++)
+				out[j] = row[(left + j) % width];
+		}
+
+		for (j = 0; j < s; j++)
+			any |= out[j];
+	}
+
+	return any != 0;
+}
+
+// Advances the window one generation. Cells within margin of the edge
+// lack neighbours and are left invalid.
+void TemporalMap::StepWindow(unsigned int margin)
+{
+	unsigned int s = window_size;
+	unsigned int x, y;
+	unsigned char *swap;
+
+	for (y = margin; y < s - margin; y++) {
+		const unsigned char* above = window + (y - 1) * s;
+		const unsigned char* row = above + s;
+		const unsigned char* below = row + s;
+		unsigned char* out = next_window + y * s;
+
+		for (x = margin; x < s - margin; x++) {
+			unsigned char count = above[x - 1] + above[x] + above[x + 1] + row[x - 1] + row[x + 1] +
+				below[x - 1] + below[x] + below[x + 1];
+
+			// On cell stays on with 2 or 3 neighbours, off cell turns on with 3
+			out[x] = (count == 3) | ((count == 2) & row[x]);
+		}
+	}
+
+	swap = window;
+	window = next_window;
+	next_window = swap;
+}
+
+// Writes the centre of the window back as the tile at (x0, y0) of the
+// next map, drawing the cells that changed
+void TemporalMap::StoreTile(unsigned int x0, unsigned int y0)
+{
+	unsigned int x1 = (x0 + TEMPORAL_TILE < width) ? x0 + TEMPORAL_TILE : width;
+	unsigned int y1 = (y0 + TEMPORAL_TILE < height) ? y0 + TEMPORAL_TILE : height;
+	unsigned int x, y;
+
+	for (y = y0; y < y1; y++) {
+		const unsigned char* in = window + (y - y0 + depth) * window_size + depth;
+		const unsigned char* old = cells + y * width + x0;
+		unsigned char* out = next_cells + y * width + x0;
+
+		for (x = 0; x < x1 - x0; x++) {
+			out[x] = in[x];
+			if (in[x] != old[x])
+				DrawCell(x0 + x, y, in[x] ? ON_COLOUR : OFF_COLOUR);
+		}
+	}
+}
+
+void TemporalMap::NextGen()
+{
+	unsigned int x0, y0, g;
+	unsigned char *swap;
+
+	for (y0 = 0; y0 < height; y0 += TEMPORAL_TILE) {
+		for (x0 = 0; x0 < width; x0 += TEMPORAL_TILE) {
+
+			tiles_processed++;
+
+			// An empty window stays empty, and so did the tile
+			if (!LoadWindow(x0, y0)) {
+				unsigned int x1 = (x0 + TEMPORAL_TILE < width) ? x0 + TEMPORAL_TILE : width;
+				unsigned int y1 = (y0 + TEMPORAL_TILE < height) ? y0 + TEMPORAL_TILE : height;
+				for (unsigned int y = y0; y < y1; y++)
+					memset(next_cells + y * width + x0, 0, x1 - x0);
+				tiles_skipped++;
+				continue;
+			}
+
+			for (g = 1; g <= depth; g++)
+				StepWindow(g);
+			StoreTile(x0, y0);
+		}
+	}
+
+	swap = cells;
+	cells = next_cells;
+	next_cells = swap;
+}
+
+void TemporalMap::PrintStats()
+{
+	cout << "Generations per pass: " << depth
+		<< "\nTiles processed: " << tiles_processed
+		<< "\nEmpty tiles skipped: " << tiles_skipped << endl;
+}
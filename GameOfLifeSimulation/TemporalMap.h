@@ -0,0 +1,58 @@
+#pragma once
+
+#include "LifeEngine.h"
+
+#include <cstdint>
+
+// Width and height of a tile in cells
+#define TEMPORAL_TILE 128
+// Generations advanced per NextGen unless set with -depth
+#define TEMPORAL_DEFAULT_DEPTH 4
+// Deepest -depth accepted; the window is then three tiles wide
+#define TEMPORAL_MAX_DEPTH TEMPORAL_TILE
+
+// TEMPORAL STRUCTURE
+/*
+Cells are stored one byte per cell (0 or 1) in two maps, one holding
+the current generation and one receiving the next. The map is divided
+into TEMPORAL_TILE x TEMPORAL_TILE tiles. Each NextGen advances depth
+generations a tile at a time: the tile and a halo of depth cells around
+it (wrapping) are loaded into a small window, which is advanced depth
+generations in place. Every generation the cells next to the window's
+edge become invalid, so the valid region shrinks by one cell per side,
+and after depth generations exactly the tile is left. Only that is
+written to the next map.
+
+The window stays in cache for all depth generations, so the whole map
+is read and written once per depth generations rather than every
+generation. The halo is recomputed by every tile that loads it, which
+costs about (1 + 2 * depth / TEMPORAL_TILE)^2 times the work of a
+plain pass.
+*/
+
+// TemporalMap advances several generations per cache-resident tile
+class TemporalMap final : public LifeEngine
+{
+public:
+	TemporalMap(unsigned int w, unsigned int h, unsigned int depth);
+	~TemporalMap();
+	void SetCell(unsigned int x, unsigned int y);
+	void ClearCell(unsigned int x, unsigned int y);
+	int CellState(int x, int y);
+	void NextGen();
+	void PrintStats();
+	uint64_t GenerationsAdvanced() const { return depth; }
+private:
+	bool LoadWindow(unsigned int x0, unsigned int y0);
+	void StepWindow(unsigned int margin);
+	void StoreTile(unsigned int x0, unsigned int y0);
+
+	unsigned char* cells;
+	unsigned char* next_cells;
+	unsigned int depth;
+	unsigned int window_size; // TEMPORAL_TILE + 2 * depth
+	unsigned char* window;
+	unsigned char* next_window;
+	uint64_t tiles_processed;
+	uint64_t tiles_skipped; // Tiles whose window was entirely dead
+};
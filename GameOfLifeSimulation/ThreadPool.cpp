@@ -0,0 +1,81 @@
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(unsigned int threads)
+{
+	if (threads == 0)
+		threads = std::thread::hardware_concurrency();
+	if (threads == 0)
+		threads = 1;
+
+	stopping = false;
+
+	// The thread calling Wait() works too, so start one fewer worker
+	for (unsigned int i = 1; i < threads; i++)
+		workers.push_back(std::thread(&ThreadPool::WorkerLoop, this));
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> guard(queue_lock);
+		stopping = true;
+	}
+	queue_ready.notify_all();
+
+	for (size_t i = 0; i < workers.size(); i++)
+		workers[i].join();
+}
+
+void ThreadPool::Submit(TaskGroup& group, std::function<void()> task)
+{
+	group.pending.fetch_add(1, std::memory_order_relaxed);
+	{
+		std::lock_guard<std::mutex> guard(queue_lock);
+		Task t = { &group, task };
+		queue.push_back(t);
+	}
+	queue_ready.notify_one();
+}
+
+// Runs the most recently queued task, if any
+bool ThreadPool::TryRunOne()
+{
+	Task t;
+	{
+		std::lock_guard<std::mutex> guard(queue_lock);
+		if (queue.empty())
+			return false;
+		t = queue.back();
+		queue.pop_back();
+	}
+
+	t.run();
+	t.group->pending.fetch_sub(1, std::memory_order_acq_rel);
+	return true;
+}
+
+void ThreadPool::Wait(TaskGroup& group)
+{
+	while (group.pending.load(std::memory_order_acquire) != 0) {
+		if (!TryRunOne())
+			std::this_thread::yield();
+	}
+}
+
+void ThreadPool::WorkerLoop()
+{
+	for (;;) {
+		Task t;
+		{
+			std::unique_lock<std::mutex> guard(queue_lock);
+			queue_ready.wait(guard, [this] { return stopping || !queue.empty(); });
+			if (queue.empty())
+				return;
+			t = queue.front();
+			queue.pop_front();
+		}
+
+		t.run();
+		t.group->pending.fetch_sub(1, std::memory_order_acq_rel);
+	}
+}
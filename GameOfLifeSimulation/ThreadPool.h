@@ -0,0 +1,44 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// TaskGroup counts the tasks submitted to a pool that have not yet finished
+struct TaskGroup
+{
+	TaskGroup() : pending(0) {}
+	std::atomic<int> pending;
+};
+
+// ThreadPool runs tasks on a fixed set of persistent worker threads.
+// Wait() runs queued tasks on the calling thread until the group is
+// done, so tasks may submit and wait on further tasks without deadlock.
+class ThreadPool
+{
+public:
+	ThreadPool(unsigned int threads); // 0 = one per hardware thread
+	~ThreadPool();
+	void Submit(TaskGroup& group, std::function<void()> task);
+	void Wait(TaskGroup& group);
+	unsigned int ThreadCount() const { return (unsigned int)workers.size() + 1; } // Workers plus the waiting thread
+private:
+	struct Task
+	{
+		TaskGroup* group;
+		std::function<void()> run;
+	};
+
+	bool TryRunOne();
+	void WorkerLoop();
+
+	std::vector<std::thread> workers;
+	std::deque<Task> queue;
+	std::mutex queue_lock;
+	std::condition_variable queue_ready;
+	bool stopping;
+};
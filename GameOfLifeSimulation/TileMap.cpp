@@ -0,0 +1,155 @@
+#include "TileMap.h"
+#include "Common.h"
+
+#include <cstring>
+#include <iostream>
+
+using namespace std;
+
+TileMap::TileMap(unsigned int w, unsigned int h) : CellMap(w, h)
+{
+	tiles_x = (w + TILE_SIZE - 1) / TILE_SIZE;
+	tiles_y = (h + TILE_SIZE - 1) / TILE_SIZE;
+	changed = new unsigned char[tiles_x * tiles_y];
+	next_changed = new unsigned char[tiles_x * tiles_y];
+	memset(changed, 0, tiles_x * tiles_y);
+	tiles_processed = 0;
+}
+
+TileMap::~TileMap()
+{
+	delete[] changed;
+	delete[] next_changed;
+}
+
+void TileMap::SetCell(unsigned int x, unsigned int y)
+{
+	CellMap::SetCell(x, y);
+	changed[TileOf(x, y)] = 1;
+}
+
+void TileMap::ClearCell(unsigned int x, unsigned int y)
+{
+	CellMap::ClearCell(x, y);
+	changed[TileOf(x, y)] = 1;
+}
+
+void TileMap::SetCells(const CellCoord* coords, size_t count)
+{
+	CellMap::SetCells(coords, count);
+	for (size_t i = 0; i < count; i++)
+		changed[TileOf(coords[i].x, coords[i].y)] = 1;
+}
+
+void TileMap::ClearCells(const CellCoord* coords, size_t count)
+{
+	CellMap::ClearCells(coords, count);
+	for (size_t i = 0; i < count; i++)
+		changed[TileOf(coords[i].x, coords[i].y)] = 1;
+}
+
+// Every tile may have changed
+void TileMap::LoadStateBitmap(const uint64_t* bitmap, unsigned int words_per_row)
+{
+	CellMap::LoadStateBitmap(bitmap, words_per_row);
+	memset(changed, 1, tiles_x * tiles_y);
+}
+
+// A tile is active if it or any of its neighbours (wrapping) changed
+void TileMap::FindActiveTiles()
+{
+	unsigned int tx, ty;
+
+	active.clear();
+	for (ty = 0; ty < tiles_y; ty++) {
+		unsigned int above = (ty == 0) ? tiles_y - 1 : ty - 1;
+		unsigned int below = (ty == tiles_y - 1) ? 0 : ty + 1;
+		for (tx = 0; tx < tiles_x; tx++) {
+			unsigned int left = (tx == 0) ? tiles_x - 1 : tx - 1;
+			unsigned int right = (tx == tiles_x - 1) ? 0 : tx + 1;
+			unsigned char any =
+				changed[above * tiles_x + left] | changed[above * tiles_x + tx] | changed[above * tiles_x + right] |
+				changed[ty * tiles_x + left] | changed[ty * tiles_x + tx] | changed[ty * tiles_x + right] |
+				changed[below * tiles_x + left] | changed[below * tiles_x + tx] | changed[below * tiles_x + right];
+			if (any)
+				active.push_back(ty * tiles_x + tx);
+		}
+	}
+}
+
+// Copies the tile to temp_cells to keep an unaltered version of it
+void TileMap::CopyTile(unsigned int tile)
+{
+	unsigned int x0 = (tile % tiles_x) * TILE_SIZE, y0 = (tile / tiles_x) * TILE_SIZE;
+	unsigned int x1 = (x0 + TILE_SIZE < width) ? x0 + TILE_SIZE : width;
+	unsigned int y1 = (y0 + TILE_SIZE < height) ? y0 + TILE_SIZE : height;
+	unsigned int y;
+
+	for (y = y0; y < y1; y++)
+		memcpy(temp_cells + y * width + x0, cells + y * width + x0, x1 - x0);
+}
+
+unsigned int TileMap::TileBytes(unsigned int tile) const
+{
+	unsigned int x0 = (tile % tiles_x) * TILE_SIZE, y0 = (tile / tiles_x) * TILE_SIZE;
+	unsigned int x1 = (x0 + TILE_SIZE < width) ? x0 + TILE_SIZE : width;
+	unsigned int y1 = (y0 + TILE_SIZE < height) ? y0 + TILE_SIZE : height;
+	return (x1 - x0) * (y1 - y0);
+}
+
+void TileMap::ProcessTile(unsigned int tile)
+{
+	unsigned int x0 = (tile % tiles_x) * TILE_SIZE, y0 = (tile / tiles_x) * TILE_SIZE;
+	unsigned int x1 = (x0 + TILE_SIZE < width) ? x0 + TILE_SIZE : width;
+	unsigned int y1 = (y0 + TILE_SIZE < height) ? y0 + TILE_SIZE : height;
+	unsigned int x, y;
+	unsigned char *cell_ptr;
+	bool any_changed = false;
+
+	for (y = y0; y < y1; y++) {
+
+		cell_ptr = temp_cells + y * width + x0;
+		for (x = x0; x < x1; x++, cell_ptr++) {
+
+			// Zero bytes are off and have no neighbours so skip them
+			if (*cell_ptr == 0)
+				continue;
+
+			if (UpdateCell(x, y, *cell_ptr))
+				any_changed = true;
+		}
+	}
+
+	next_changed[tile] = any_changed;
+}
+
+void TileMap::NextGen()
+{
+	unsigned int i;
+
+	FindActiveTiles();
+
+	// Copy only the active tiles; nothing outside them is read this generation
+	for (i = 0; i < active.size(); i++) {
+		CopyTile(active[i]);
+		bytes_copied += TileBytes(active[i]);
+	}
+
+	memset(next_changed, 0, tiles_x * tiles_y);
+	for (i = 0; i < active.size(); i++)
+		ProcessTile(active[i]);
+
+	unsigned char* swap = changed;
+	changed = next_changed;
+	next_changed = swap;
+
+	tiles_processed += active.size();
+	generations++;
+}
+
+void TileMap::PrintStats()
+{
+	cout << "Tiles: " << tiles_x * tiles_y
+		<< "\nAverage active tiles: " << (generations ? (double)tiles_processed / generations : 0.0) << endl;
+	CellMap::PrintStats();
+}
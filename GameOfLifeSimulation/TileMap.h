@@ -0,0 +1,48 @@
+#pragma once
+
+#include "CellMap.h"
+
+#include <cstdint>
+#include <vector>
+
+// Width and height of a tile in cells
+#define TILE_SIZE 64
+
+// TILE STRUCTURE
+/*
+Cells use the CellMap byte layout, with the map divided into
+TILE_SIZE x TILE_SIZE tiles (tiles on the right and bottom edges may be
+smaller). A cell can only change if it or one of its neighbours changed
+last generation, so a tile only needs processing if a cell changed in it
+or in one of its eight neighbouring tiles (wrapping at the edges). Only
+active tiles are copied to temp_cells and scanned, so settled or empty
+regions cost nothing.
+*/
+
+// TileMap is a CellMap that only processes tiles with recent activity
+class TileMap : public CellMap
+{
+public:
+	TileMap(unsigned int w, unsigned int h);
+	~TileMap();
+	void SetCell(unsigned int x, unsigned int y);
+	void ClearCell(unsigned int x, unsigned int y);
+	void SetCells(const CellCoord* coords, size_t count);
+	void ClearCells(const CellCoord* coords, size_t count);
+	void LoadStateBitmap(const uint64_t* bitmap, unsigned int words_per_row);
+	void NextGen();
+	void PrintStats();
+protected:
+	unsigned int TileOf(unsigned int x, unsigned int y) const { return (y / TILE_SIZE) * tiles_x + x / TILE_SIZE; }
+	void FindActiveTiles();
+	void CopyTile(unsigned int tile);
+	unsigned int TileBytes(unsigned int tile) const; // Bytes CopyTile copies
+	void ProcessTile(unsigned int tile);
+
+	unsigned int tiles_x;
+	unsigned int tiles_y;
+	unsigned char* changed; // Tiles with a cell changed since the last NextGen
+	unsigned char* next_changed; // Tiles with a cell changed by this NextGen
+	std::vector<unsigned int> active; // Tiles to process this generation
+	uint64_t tiles_processed;
+};
@@ -0,0 +1,150 @@
+#include "WorkStealingPool.h"
+
+#include <iostream>
+
+WorkStealingPool::WorkStealingPool(unsigned int threads)
+{
+	if (threads == 0)
+		threads = std::thread::hardware_concurrency();
+	if (threads == 0)
+		threads = 1;
+
+	thread_count = threads;
+	workers = new Worker[threads];
+	for (unsigned int i = 0; i < threads; i++) {
+		workers[i].executed = 0;
+		workers[i].stolen = 0;
+	}
+
+	run_id = 0;
+	busy = 0;
+	stopping = false;
+	current_task = NULL;
+	remaining = 0;
+
+	for (unsigned int i = 1; i < threads; i++)
+		this->threads.push_back(std::thread(&WorkStealingPool::WorkerLoop, this, i));
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+	{
+		std::lock_guard<std::mutex> guard(run_lock);
+		stopping = true;
+	}
+	run_start.notify_all();
+
+	for (size_t i = 0; i < threads.size(); i++)
+		threads[i].join();
+	delete[] workers;
+}
+
+// Takes the most recently added task from the thread's own deque
+bool WorkStealingPool::Pop(unsigned int self, unsigned int& item)
+{
+	Worker& w = workers[self];
+	std::lock_guard<std::mutex> guard(w.lock);
+	if (w.tasks.empty())
+		return false;
+	item = w.tasks.back();
+	w.tasks.pop_back();
+	return true;
+}
+
+// Takes the oldest task from the first other thread that has one
+bool WorkStealingPool::Steal(unsigned int self, unsigned int& item)
+{
+	for (unsigned int i = 1; i < thread_count; i++) {
+		Worker& victim = workers[(self + i) % thread_count];
+		std::lock_guard<std::mutex> guard(victim.lock);
+		if (!victim.tasks.empty()) {
+			item = victim.tasks.front();
+			victim.tasks.pop_front();
+			return true;
+		}
+	}
+	return false;
+}
+
+void WorkStealingPool::Work(unsigned int self)
+{
+	Worker& w = workers[self];
+	unsigned int item;
+
+	while (remaining.load(std::memory_order_acquire) != 0) {
+		if (Pop(self, item)) {
+			(*current_task)(item);
+		}
+		else if (Steal(self, item)) {
+			(*current_task)(item);
+			w.stolen++;
+		}
+		else {
+			std::this_thread::yield();
+			continue;
+		}
+		w.executed++;
+		remaining.fetch_sub(1, std::memory_order_acq_rel);
+	}
+}
+
+void WorkStealingPool::WorkerLoop(unsigned int self)
+{
+	unsigned int seen = 0;
+	for (;;) {
+		{
+			std::unique_lock<std::mutex> guard(run_lock);
+			run_start.wait(guard, [this, seen] { return stopping || run_id != seen; });
+			if (stopping)
+				return;
+			seen = run_id;
+		}
+
+		Work(self);
+
+		{
+			std::lock_guard<std::mutex> guard(run_lock);
+			if (--busy == 0)
+				run_done.notify_one();
+		}
+	}
+}
+
+// Runs task(item) for every item and returns once they have all finished
+void WorkStealingPool::Run(const std::vector<unsigned int>& items, const std::function<void(unsigned int)>& task)
+{
+	if (items.empty())
+		return;
+
+	// Seed each deque with a contiguous chunk, keeping neighbouring items together
+	size_t n = items.size();
+	for (unsigned int i = 0; i < thread_count; i++) {
+		size_t first = n * i / thread_count, last = n * (i + 1) / thread_count;
+		std::lock_guard<std::mutex> guard(workers[i].lock);
+		workers[i].tasks.assign(items.begin() + first, items.begin() + last);
+	}
+
+	{
+		std::lock_guard<std::mutex> guard(run_lock);
+		current_task = &task;
+		remaining = n;
+		busy = thread_count - 1;
+		run_id++;
+	}
+	run_start.notify_all();
+
+	Work(0);
+
+	// Wait for the other threads to let go of the task
+	std::unique_lock<std::mutex> guard(run_lock);
+	run_done.wait(guard, [this] { return busy == 0; });
+	current_task = NULL;
+}
+
+void WorkStealingPool::PrintStats()
+{
+	for (unsigned int i = 0; i < thread_count; i++) {
+		std::cout << "Thread " << i << ": " << workers[i].executed << " tasks executed, "
+			<< workers[i].stolen << " stolen" << std::endl;
+	}
+}
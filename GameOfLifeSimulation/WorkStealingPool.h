@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// WorkStealingPool runs a batch of tasks (identified by unsigned ints) on
+// persistent threads. Each thread owns a deque seeded with a contiguous
+// chunk of the batch; it takes work from the back of its own deque and,
+// once that is empty, steals from the front of the others. This keeps
+// threads busy when the cost of tasks is very uneven.
+class WorkStealingPool
+{
+public:
+	WorkStealingPool(unsigned int threads); // 0 = one per hardware thread
+	~WorkStealingPool();
+	void Run(const std::vector<unsigned int>& items, const std::function<void(unsigned int)>& task);
+	unsigned int ThreadCount() const { return thread_count; }
+	void PrintStats();
+private:
+	struct Worker
+	{
+		std::mutex lock;
+		std::deque<unsigned int> tasks;
+		uint64_t executed; // Tasks run by this thread
+		uint64_t stolen; // Of those, tasks taken from another thread's deque
+	};
+
+	bool Pop(unsigned int self, unsigned int& item);
+	bool Steal(unsigned int self, unsigned int& item);
+	void Work(unsigned int self);
+	void WorkerLoop(unsigned int self);
+
+	unsigned int thread_count;
+	Worker* workers; // Worker 0 is the thread calling Run()
+	std::vector<std::thread> threads;
+
+	std::mutex run_lock;
+	std::condition_variable run_start;
+	std::condition_variable run_done;
+	unsigned int run_id; // Incremented for each batch
+	unsigned int busy; // Threads still working on the current batch
+	bool stopping;
+	const std::function<void(unsigned int)>* current_task;
+	std::atomic<size_t> remaining; // Tasks in the batch not yet finished
+};
@@ -2,48 +2,46 @@
 #pragma once
 
 #include <SDL.h>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
 #include <ctime>
+#include <fstream>
 #include <iostream>
+#include <sstream>
 #include <windows.h>
 
-#define OFF_COLOUR 0x00
-#define ON_COLOUR 0xFF
+#include "Common.h"
+#include "CellMap.h"
+#include "BitPackedMap.h"
+#include "HashLife.h"
+#include "TileMap.h"
+#include "ChangeListMap.h"
+#include "QLifeMap.h"
+#include "BandedMap.h"
+#include "StealingTileMap.h"
+#include "BlockMap.h"
+#include "TemporalMap.h"
+#include "PipelineMap.h"
+#include "RollingMap.h"
+#include "SparseMap.h"
+#include "HaloMap.h"
+#include "IsotropicMap.h"
+#include "LtLMap.h"
+#include "StochasticMap.h"
 
 // Limit loop rate for visibility
 #define LIMIT_RATE 0
 // Tick-rate in milliseconds (if LIMIT_RATE == 1)
 #define TICK_RATE 50
 
+// Most worker threads -threads accepts
+#define MAX_THREADS 256
+
 // Standard Library
 using namespace std;
 
-// CELL STRUCTURE
-/* 
-Cells are stored in 8-bit chars where the 0th bit represents
-the cell state and the 1st to 4th bit represent the number
-of neighbours (up to 8). The 5th to 7th bits are unused.
-Refer to this diagram: http://www.jagregory.com/abrash-black-book/images/17-03.jpg
-*/
-
-// CellMap stores an array of cells with their states
-class CellMap
-{
-public:
-	CellMap(unsigned int w, unsigned int h);
-	~CellMap();
-	void SetCell(unsigned int x, unsigned int y);
-	void ClearCell(unsigned int x, unsigned int y);
-	int CellState(int x, int y); // WHY NOT UNSIGNED?
-	void NextGen();
-	void Init();
-private:
-	unsigned char* cells;
-	unsigned char* temp_cells;
-	unsigned int width;
-	unsigned int height;
-	unsigned int length_in_bytes;
-};
-
 // Cell map dimensions
 unsigned int cellmap_width = 500;
 unsigned int cellmap_height = 500;
@@ -51,8 +49,52 @@ unsigned int cellmap_height = 500;
 // Width and height (in pixels) of a cell i.e. magnification
 unsigned int cell_size = 1;
 
-// Randomisation seed
-unsigned int seed;
+// Randomisation seed (-seed, 0 = from the clock)
+unsigned int seed = 0;
+
+// Fraction of cells Init turns on (-density)
+double density = 0.5;
+
+// Simulation engine (selected with -engine)
+const char* engine_name = "cellmap";
+
+// Generations advanced per frame as a power of 2 (hashlife only, -step)
+unsigned int step_log2 = 0;
+
+// Memory budget for HashLife nodes in megabytes (-hashmem)
+unsigned int hashlife_budget_mb = HASHLIFE_DEFAULT_BUDGET_MB;
+
+// Generations advanced per frame by the temporal engine (-depth)
+unsigned int temporal_depth = TEMPORAL_DEFAULT_DEPTH;
+
+// Life-like or Generations rule in B/S notation (-rule)
+LifeRule rule;
+
+// Rule in Hensel notation, when it is not Life-like (isotropic only)
+IsotropicRule isotropic_rule;
+
+// Rule in Larger than Life notation (ltl only)
+LtLRule ltl_rule;
+
+// Which of the rules above -rule gave
+enum RuleKind { RULE_LIFE, RULE_HENSEL, RULE_LTL };
+RuleKind rule_kind = RULE_LIFE;
+const char* rule_string = "B3/S23";
+
+// What lies beyond the edges of the map (halo only, -boundary)
+Boundary boundary = BOUNDARY_TORUS;
+
+// Probabilities of a birth or survival the rule allows happening, and
+// of a cell flipping each generation (stochastic only, -pbirth, -psurvive, -noise)
+double birth_probability = 1.0;
+double survive_probability = 1.0;
+double noise = 0.0;
+
+// Pattern stamped in the middle of the map after Init (-pattern)
+Pattern pattern;
+
+// Worker threads for the multithreaded engines (-threads, 0 = one per core)
+unsigned int threads = 1;
 
 // Graphics
 SDL_Window *window = NULL;
@@ -76,19 +118,192 @@ void DrawCell(unsigned int x, unsigned int y, unsigned int colour)
 	}
 }
 
+// Looks up a boundary policy by name, returning false if unknown
+bool ParseBoundary(const char* name, Boundary& b)
+{
+	if (strcmp(name, "torus") == 0)
+		b = BOUNDARY_TORUS;
+	else if (strcmp(name, "dead") == 0)
+		b = BOUNDARY_DEAD;
+	else if (strcmp(name, "klein") == 0)
+		b = BOUNDARY_KLEIN;
+	else if (strcmp(name, "mirror") == 0)
+		b = BOUNDARY_MIRROR;
+	else
+		return false;
+	return true;
+}
+
+// Parses a rulestring in B/S notation, or failing that in Hensel or
+// Larger than Life notation, returning false if it is none of them
+bool ParseRule(const char* rulestring)
+{
+	if (rule.Parse(rulestring))
+		rule_kind = RULE_LIFE;
+	else if (isotropic_rule.Parse(rulestring))
+		rule_kind = RULE_HENSEL;
+	else if (ltl_rule.Parse(rulestring))
+		rule_kind = RULE_LTL;
+	else
+		return false;
+	rule_string = rulestring;
+	return true;
+}
+
+// Gives the engine the rule from -rule, returning false if it can't run it
+bool SetEngineRule(LifeEngine* map)
+{
+	switch (rule_kind)
+	{
+	case RULE_HENSEL:
+		return map->SetIsotropicRule(isotropic_rule);
+	case RULE_LTL:
+		return map->SetLtLRule(ltl_rule);
+	default:
+		return map->SetRule(rule);
+	}
+}
+
+// Reads a plaintext (.cells) pattern file, returning false if it can't
+bool LoadPattern(const char* path)
+{
+	ifstream file(path);
+	if (!file)
+		return false;
+	stringstream text;
+	text << file.rdbuf();
+	return pattern.Parse(text.str().c_str());
+}
+
+// Reads a probability from 0 to 1, returning false if it is not one
+bool ParseProbability(const char* text, double& p)
+{
+	char* end;
+	double value = strtod(text, &end);
+	if (end == text || *end != '\0' || !(value >= 0.0 && value <= 1.0))
+		return false;
+	p = value;
+	return true;
+}
+
+// Reads a whole number from 0 to max, returning false if it is not one
+bool ParseCount(const char* text, unsigned int& n, unsigned int max)
+{
+	// strtoul would accept a sign or leading spaces, and wrap negative numbers
+	if (!isdigit((unsigned char)text[0]))
+		return false;
+
+	char* end;
+	errno = 0;
+	unsigned long value = strtoul(text, &end, 10);
+	if (*end != '\0' || errno == ERANGE || value > max)
+		return false;
+	n = (unsigned int)value;
+	return true;
+}
+
+// Creates the named simulation engine, or returns NULL if unknown
+LifeEngine* CreateEngine(const char* name, unsigned int w, unsigned int h)
+{
+	if (strcmp(name, "cellmap") == 0)
+		return new CellMap(w, h);
+	if (strcmp(name, "bitpacked") == 0)
+		return new BitPackedMap(w, h);
+	if (strcmp(name, "block") == 0)
+		return new BlockMap(w, h);
+	if (strcmp(name, "banded") == 0)
+		return new BandedMap(w, h, threads);
+	if (strcmp(name, "rolling") == 0)
+		return new RollingMap(w, h);
+	if (strcmp(name, "halo") == 0)
+		return new HaloMap(w, h, boundary);
+	if (strcmp(name, "isotropic") == 0)
+		return new IsotropicMap(w, h);
+	if (strcmp(name, "ltl") == 0)
+		return new LtLMap(w, h);
+	if (strcmp(name, "stochastic") == 0)
+		return new StochasticMap(w, h, threads, birth_probability, survive_probability, noise);
+	if (strcmp(name, "tiled") == 0)
+		return new TileMap(w, h);
+	if (strcmp(name, "stealing") == 0)
+		return new StealingTileMap(w, h, threads);
+	if (strcmp(name, "temporal") == 0)
+		return new TemporalMap(w, h, temporal_depth);
+	if (strcmp(name, "pipeline") == 0)
+		return new PipelineMap(w, h, threads);
+	if (strcmp(name, "changelist") == 0)
+		return new ChangeListMap(w, h);
+	if (strcmp(name, "qlife") == 0)
+		return new QLifeMap(w, h);
+	if (strcmp(name, "sparse") == 0)
+		return new SparseMap(w, h);
+	if (strcmp(name, "hashlife") == 0)
+		return new HashLifeMap(w, h, step_log2, threads, (size_t)hashlife_budget_mb << 20);
+	return NULL;
+}
+
 int main(int argc, char* argv[])
 {
+	// Command line options
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "-engine") == 0 && i + 1 < argc)
+			engine_name = argv[++i];
+		else if (strcmp(argv[i], "-step") == 0 && i + 1 < argc && ParseCount(argv[i + 1], step_log2, HASHLIFE_MAX_STEP))
+			i++;
+		else if (strcmp(argv[i], "-hashmem") == 0 && i + 1 < argc && ParseCount(argv[i + 1], hashlife_budget_mb, HASHLIFE_MAX_BUDGET_MB))
+			i++;
+		else if (strcmp(argv[i], "-depth") == 0 && i + 1 < argc && ParseCount(argv[i + 1], temporal_depth, TEMPORAL_MAX_DEPTH))
+			i++;
+		else if (strcmp(argv[i], "-rule") == 0 && i + 1 < argc && ParseRule(argv[i + 1]))
+			i++;
+		else if (strcmp(argv[i], "-boundary") == 0 && i + 1 < argc && ParseBoundary(argv[i + 1], boundary))
+			i++;
+		else if (strcmp(argv[i], "-pbirth") == 0 && i + 1 < argc && ParseProbability(argv[i + 1], birth_probability))
+			i++;
+		else if (strcmp(argv[i], "-psurvive") == 0 && i + 1 < argc && ParseProbability(argv[i + 1], survive_probability))
+			i++;
+		else if (strcmp(argv[i], "-noise") == 0 && i + 1 < argc && ParseProbability(argv[i + 1], noise))
+			i++;
+		else if (strcmp(argv[i], "-seed") == 0 && i + 1 < argc)
+			seed = (unsigned int)strtoul(argv[++i], NULL, 10);
+		else if (strcmp(argv[i], "-density") == 0 && i + 1 < argc && ParseProbability(argv[i + 1], density))
+			i++;
+		else if (strcmp(argv[i], "-pattern") == 0 && i + 1 < argc && LoadPattern(argv[i + 1]))
+			i++;
+		else if (strcmp(argv[i], "-threads") == 0 && i + 1 < argc && ParseCount(argv[i + 1], threads, MAX_THREADS))
+			i++;
+		else
+		{
+			cout << "Usage: " << argv[0] << " [-engine cellmap|bitpacked|block|banded|rolling|halo|isotropic|ltl|stochastic|tiled|stealing|temporal|pipeline|changelist|qlife|sparse|hashlife] [-rule B3/S23] [-step k] [-depth k] [-hashmem MB] [-boundary torus|dead|klein|mirror] [-pbirth p] [-psurvive p] [-noise p] [-seed n] [-density p] [-pattern file.cells] [-threads n]" << endl;
+			return 1;
+		}
+	}
+
+	// Initialise cell map
+	LifeEngine* current_map = CreateEngine(engine_name, cellmap_width, cellmap_height);
+	if (current_map == NULL)
+	{
+		cout << "Unknown engine: " << engine_name << endl;
+		return 1;
+	}
+	if (!SetEngineRule(current_map))
+	{
+		cout << "The " << engine_name << " engine can't run " << rule_string << endl;
+		delete current_map;
+		return 1;
+	}
+
 	// SDL boilerplate
 	SDL_Init(SDL_INIT_VIDEO);
 	window = SDL_CreateWindow("Conway's Game of Life", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, s_width, s_height, SDL_WINDOW_SHOWN);
 	surface = SDL_GetWindowSurface(window);
 
-	// Generation counter
-	unsigned long generation = 0;
+	// Generation counter (engines may advance several generations per frame)
+	uint64_t generation = 0;
 
-	// Initialise cell map
-	CellMap current_map(cellmap_width, cellmap_height);
-	current_map.Init(); // Randomly initialize cell map
+	current_map->Init(); // Randomly initialize cell map
+	current_map->Stamp(pattern, ((int)cellmap_width - (int)pattern.width) / 2, ((int)cellmap_height - (int)pattern.height) / 2);
 
 	// SDL Event handler
 	SDL_Event e;
@@ -99,10 +314,9 @@ int main(int argc, char* argv[])
 		while (SDL_PollEvent(&e) != 0) 
 			if (e.type == SDL_QUIT) quit = true;
 
-		generation++;
-
 		// Recalculate and draw next generation
-		current_map.NextGen();
+		current_map->NextGen();
+		generation += current_map->GenerationsAdvanced();
 		// Update frame buffer
 		SDL_UpdateWindowSurface(window);
 
@@ -111,6 +325,9 @@ int main(int argc, char* argv[])
 #endif
 	}
 
+	current_map->PrintStats();
+	delete current_map;
+
 	// Destroy window 
 	SDL_DestroyWindow(window); 
 	// Quit SDL subsystems 
@@ -123,152 +340,3 @@ int main(int argc, char* argv[])
 
 	return 0;
 }
-
-CellMap::CellMap(unsigned int w, unsigned int h)
-{
-	width = w;
-	height = h;
-	length_in_bytes = w * h;
-	cells = new unsigned char[length_in_bytes];  // cell storage
-	temp_cells = new unsigned char[length_in_bytes]; // temp cell storage
-	memset(cells, 0, length_in_bytes);  // clear all cells, to start
-}
-
-CellMap::~CellMap()
-{
-	delete[] cells;
-	delete[] temp_cells;
-}
-
-void CellMap::SetCell(unsigned int x, unsigned int y)
-{
-	int w = width, h = height;
-	int xoleft, xoright, yoabove, yobelow;
-	unsigned char *cell_ptr = cells + (y * w) + x;
-
-	// Calculate the offsets to the eight neighboring cells,
-	// accounting for wrapping around at the edges of the cell map
-	xoleft = (x == 0) ? w - 1 : -1;
-	xoright = (x == (w - 1)) ? -(w - 1) : 1;
-	yoabove = (y == 0) ? length_in_bytes - w : -w;
-	yobelow = (y == (h - 1)) ? -(length_in_bytes - w) : w;
-
-	*(cell_ptr) |= 0x01; // Set first bit to 1
-
-	// Change successive bits for neighbour counts
-	*(cell_ptr + yoabove + xoleft) += 0x02;
-	*(cell_ptr + yoabove) += 0x02;
-	*(cell_ptr + yoabove + xoright) += 0x02;
-	*(cell_ptr + xoleft) += 0x02;
-	*(cell_ptr + xoright) += 0x02;
-	*(cell_ptr + yobelow + xoleft) += 0x02;
-	*(cell_ptr + yobelow) += 0x02;
-	*(cell_ptr + yobelow + xoright) += 0x02;
-}
-
-void CellMap::ClearCell(unsigned int x, unsigned int y)
-{
-	int w = width, h = height;
-	int xoleft, xoright, yoabove, yobelow;
-	unsigned char *cell_ptr = cells + (y * w) + x;
-
-	// Calculate the offsets to the eight neighboring cells,
-	// accounting for wrapping around at the edges of the cell map
-	xoleft = (x == 0) ? w - 1 : -1;
-	xoright = (x == (w - 1)) ? -(w - 1) : 1;
-	yoabove = (y == 0) ? length_in_bytes - w : -w;
-	yobelow = (y == (h - 1)) ? -(length_in_bytes - w) : w;
-
-
-	*(cell_ptr) &= ~0x01; // Set first bit to 0
-
-	// Change successive bits for neighbour counts
-	*(cell_ptr + yoabove + xoleft) -= 0x02;
-	*(cell_ptr + yoabove) -= 0x02;
-	*(cell_ptr + yoabove + xoright) -= 0x02;
-	*(cell_ptr + xoleft) -= 0x02;
-	*(cell_ptr + xoright) -= 0x02;
-	*(cell_ptr + yobelow + xoleft) -= 0x02;
-	*(cell_ptr + yobelow) -= 0x02;
-	*(cell_ptr + yobelow + xoright) -= 0x02;
-}
-
-int CellMap::CellState(int x, int y)
-{
-	unsigned char *cell_ptr =
-		cells + (y * width) + x;
-
-	// Return first bit (LSB: cell state stored here)
-	return *cell_ptr & 0x01;
-}
-
-void CellMap::NextGen()
-{
-	unsigned int x, y, count;
-	unsigned int h = height, w = width;
-	unsigned char *cell_ptr;
-
-	// Copy to temp map to keep an unaltered version
-	memcpy(temp_cells, cells, length_in_bytes);
-
-	// Process all cells in the current cell map
-	cell_ptr = temp_cells;
-	for (y = 0; y < h; y++) {
-
-		x = 0;
-		do {
-
-			// Zero bytes are off and have no neighbours so skip them...
-			while (*cell_ptr == 0) {
-				cell_ptr++; // Advance to the next cell
-				// If all cells in row are off with no neighbours go to next row
-				if (++x >= w) goto RowDone;
-			}
-
-			// Remaining cells are either on or have neighbours
-			count = *cell_ptr >> 1; // # of neighboring on-cells
-			if (*cell_ptr & 0x01) {
-
-				// On cell must turn off if not 2 or 3 neighbours
-				if ((count != 2) && (count != 3)) {
-					ClearCell(x, y);
-					DrawCell(x, y, OFF_COLOUR);
-				}
-			}
-			else {
-
-				// Off cell must turn on if 3 neighbours
-				if (count == 3) {
-					SetCell(x, y);
-					DrawCell(x, y, ON_COLOUR);
-				}
-			}
-
-			// Advance to the next cell byte
-			cell_ptr++;
-
-		} while (++x < w);
-	RowDone:;
-	}
-}
-
-void CellMap::Init()
-{
-	unsigned int x, y, init_length;
-
-	// Get seed; random if 0
-	seed = (unsigned)time(NULL);
-
-	// Randomly initialise cell map with ~50% on pixels
-	cout << "Initializing" << endl;
-
-	srand(seed);
-	init_length = (width * height) / 2;
-	do
-	{
-		x = rand() % (width - 1);
-		y = rand() % (height - 1);
-		if (CellState(x, y) == 0)
-			SetCell(x, y);
-	} while (--init_length);
-}
\ No newline at end of file